@@ -7,6 +7,8 @@ out vec2 v_TexCoord;
 
 uniform mat4 u_MVP;
 
+invariant gl_Position; // Same depth as RenderQueue's pre-pass, which draws with a different program
+
 void main() {
     gl_Position = u_MVP * position;
     v_TexCoord = texCoord;
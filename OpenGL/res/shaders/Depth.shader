@@ -0,0 +1,20 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec4 position;
+
+uniform mat4 u_MVP;
+
+invariant gl_Position; // Bit-identical to the shading pass, whose GL_LEQUAL test must pass on equal depth
+
+void main() {
+    gl_Position = u_MVP * position;
+};
+
+
+
+#shader fragment
+#version 330 core
+
+// No color output, the pre-pass only writes depth
+void main() {
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#shader compute
+#version 430 core
+layout(local_size_x = 64) in; // CULL_GROUP_SIZE in GpuCuller.cpp
+
+struct Object {
+    vec4 sphere; // World-space center and radius
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint padding;
+};
+
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance; // Object index, fetched by the vertex shader's per-instance attribute
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 2) writeonly buffer Commands { DrawCommand commands[]; };
+layout(std430, binding = 3) buffer DrawCount { uint drawCount; };
+
+uniform vec4 u_Planes[6]; // Normalized, inside where dot(plane.xyz, p) + plane.w >= 0
+uniform int u_ObjectCount;
+uniform int u_Compact; // 1: append visible draws and count them, 0: keep every draw, hidden ones with 0 instances
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= uint(u_ObjectCount)) {
+        return;
+    }
+
+    Object object = objects[index];
+    bool visible = true;
+    for (int p = 0; p < 6; p++) {
+        visible = visible && dot(u_Planes[p].xyz, object.sphere.xyz) + u_Planes[p].w >= -object.sphere.w;
+    }
+
+    uint slot = index;
+    if (u_Compact != 0) {
+        if (!visible) {
+            return;
+        }
+        slot = atomicAdd(drawCount, 1u);
+    }
+    commands[slot] = DrawCommand(object.indexCount, visible ? 1u : 0u, object.firstIndex, object.baseVertex, index);
+};
\ No newline at end of file
@@ -0,0 +1,31 @@
+#shader vertex
+#version 430 core
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in uint i_ObjectIndex; // The draw's baseInstance, the first location after the arena's layout
+
+layout(std430, binding = 1) readonly buffer Transforms { mat4 models[]; }; // GpuCuller::TRANSFORM_BINDING
+
+uniform mat4 u_ViewProjection;
+
+out vec2 v_TexCoord;
+
+void main() {
+    gl_Position = u_ViewProjection * models[i_ObjectIndex] * position;
+    v_TexCoord = texCoord;
+};
+
+
+
+#shader fragment
+#version 430 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main() {
+    color = texture(u_Texture, v_TexCoord);
+};
\ No newline at end of file
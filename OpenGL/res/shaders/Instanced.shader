@@ -0,0 +1,27 @@
+#shader vertex
+#version 330 core
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in mat4 i_MVP; // Per instance, locations 2 to 5, written by TransformSystem::WriteInstances
+
+out vec2 v_TexCoord;
+
+void main() {
+    gl_Position = i_MVP * position;
+    v_TexCoord = texCoord;
+};
+
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main() {
+    color = texture(u_Texture, v_TexCoord);
+};
\ No newline at end of file
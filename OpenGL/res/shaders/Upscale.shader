@@ -0,0 +1,38 @@
+#shader vertex
+#version 330 core
+
+out vec2 v_TexCoord;
+
+void main() {
+    // One triangle covering the screen, no vertex data
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    v_TexCoord = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+};
+
+
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture; // Low-resolution input, linearly filtered
+uniform vec2 u_TexelSize; // One texel of the input
+uniform float u_Sharpness; // 0 is plain bilinear
+
+void main() {
+    vec4 center = texture(u_Texture, v_TexCoord);
+    vec3 north = texture(u_Texture, v_TexCoord + vec2(0.0, u_TexelSize.y)).rgb;
+    vec3 south = texture(u_Texture, v_TexCoord - vec2(0.0, u_TexelSize.y)).rgb;
+    vec3 east = texture(u_Texture, v_TexCoord + vec2(u_TexelSize.x, 0.0)).rgb;
+    vec3 west = texture(u_Texture, v_TexCoord - vec2(u_TexelSize.x, 0.0)).rgb;
+
+    // Unsharp mask against the cross, clamped to the neighborhood so edges don't ring
+    vec3 minimum = min(center.rgb, min(min(north, south), min(east, west)));
+    vec3 maximum = max(center.rgb, max(max(north, south), max(east, west)));
+    vec3 sharpened = center.rgb + u_Sharpness * (4.0 * center.rgb - (north + south + east + west));
+    color = vec4(clamp(sharpened, minimum, maximum), center.a);
+};
\ No newline at end of file
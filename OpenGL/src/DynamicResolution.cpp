@@ -0,0 +1,79 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const float BUDGET_HEADROOM = 0.9f; // Of the target, the rest absorbs spikes and unscaled work
+static const float LOW_WATERMARK = 0.75f; // Of the budget, below it the scale goes back up
+static const float SCALE_STEP = 0.05f; // Scales snap to it, so the targets only come in a few sizes
+static const float MAX_STEP = 0.15f; // Largest change at once
+static const unsigned int SETTLE_FRAMES = 8; // Measurements arrive a few frames late, wait for the new scale's
+
+DynamicResolution::DynamicResolution(const AssetPack& pack, float targetMilliseconds)
+	: m_UpscaleShader(pack, "res/shaders/Upscale.shader"), m_TargetMilliseconds(targetMilliseconds),
+	m_MinScale(0.5f), m_MaxScale(1.0f), m_Scale(1.0f), m_Sharpness(0.3f), m_FramesSinceChange(0), m_Enabled(true)
+{
+}
+
+void DynamicResolution::BeginFrame() {
+	m_FrameTimer.Begin();
+}
+
+void DynamicResolution::EndFrame() {
+	m_FrameTimer.End();
+	m_FramesSinceChange++;
+	if (!m_Enabled || !m_FrameTimer.HasResult() || m_FramesSinceChange < SETTLE_FRAMES) {
+		return;
+	}
+
+	const float budget = m_TargetMilliseconds * BUDGET_HEADROOM;
+	const float measured = std::max(m_FrameTimer.GetMilliseconds(), 0.01f);
+	if (measured <= budget && measured >= budget * LOW_WATERMARK) {
+		return; // Inside the dead band
+	}
+
+	// Aim for the middle of the band, cost follows the pixel count, which is the scale squared
+	const float goal = budget * (1.0f + LOW_WATERMARK) * 0.5f;
+	float scale = m_Scale * std::sqrt(goal / measured);
+	scale = std::min(std::max(scale, m_Scale - MAX_STEP), m_Scale + MAX_STEP);
+	scale = std::round(scale / SCALE_STEP) * SCALE_STEP;
+	scale = std::min(std::max(scale, m_MinScale), m_MaxScale);
+	if (std::fabs(scale - m_Scale) > SCALE_STEP * 0.5f) {
+		m_Scale = scale;
+		m_FramesSinceChange = 0;
+	}
+}
+
+void DynamicResolution::GetRenderSize(int width, int height, int& renderWidth, int& renderHeight) const {
+	renderWidth = std::max((int)(width * m_Scale + 0.5f), 1);
+	renderHeight = std::max((int)(height * m_Scale + 0.5f), 1);
+}
+
+void DynamicResolution::AddUpscalePass(RenderGraph& graph, RenderGraphResource input, RenderGraphResource output) {
+	graph.AddPass("Upscale", [this, input](const Renderer& renderer, const RenderGraph& graph) {
+		const Framebuffer& source = *graph.GetTarget(input);
+		GLCall(glDisable(GL_DEPTH_TEST)); // Every pixel is overwritten
+		GLCall(glDisable(GL_BLEND));
+
+		m_UpscaleShader.Bind();
+		source.BindColorTexture(TARGET_TEXTURE_SLOT); // Filtered linearly, that is the bilinear part
+		m_UpscaleShader.SetUniform1i("u_Texture", TARGET_TEXTURE_SLOT);
+		m_UpscaleShader.SetUniform2f("u_TexelSize", 1.0f / source.GetWidth(), 1.0f / source.GetHeight());
+		m_UpscaleShader.SetUniform1f("u_Sharpness", m_Sharpness);
+		renderer.DrawFullscreen(m_EmptyArray, m_UpscaleShader);
+	}).Read(input).Write(output);
+}
+
+void DynamicResolution::SetEnabled(bool enabled) {
+	m_Enabled = enabled;
+	if (!enabled) {
+		m_Scale = m_MaxScale;
+	}
+	m_FramesSinceChange = 0;
+}
+
+void DynamicResolution::SetScaleRange(float minScale, float maxScale) {
+	m_MinScale = minScale;
+	m_MaxScale = maxScale;
+	m_Scale = std::min(std::max(m_Scale, m_MinScale), m_MaxScale);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Shader.h"
+#include "GpuTimer.h"
+#include "RenderGraph.h"
+
+// Scales the resolution the scene renders at to keep the GPU's frame time inside a budget, then
+// upscales to the window in one pass (res/shaders/Upscale.shader, bilinear plus an optional
+// sharpen clamped to the neighborhood so edges don't ring). GPU time is measured between
+// BeginFrame and EndFrame with a GpuTimer; it is roughly proportional to the pixel count, so a
+// new scale is sqrt(goal / measured) times the old one. Steps are limited and quantized, with a
+// dead band and a settling delay for the late measurements, so the targets are not
+// reallocated every frame.
+class DynamicResolution {
+private:
+	GpuTimer m_FrameTimer;
+	Shader m_UpscaleShader;
+	VertexArray m_EmptyArray; // The full-screen triangle has no vertex data
+	float m_TargetMilliseconds;
+	float m_MinScale, m_MaxScale;
+	float m_Scale; // Of each axis
+	float m_Sharpness;
+	unsigned int m_FramesSinceChange;
+	bool m_Enabled;
+public:
+	DynamicResolution(const AssetPack& pack, float targetMilliseconds = 1000.0f / 60.0f); // Loads res/shaders/Upscale.shader
+
+	DynamicResolution(const DynamicResolution&) = delete;
+	DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+	void BeginFrame(); // Before the frame's first GPU command
+	void EndFrame(); // After its last one, adjusts the scale from the latest finished measurement
+
+	// Size to render the scene at for a window of width x height
+	void GetRenderSize(int width, int height, int& renderWidth, int& renderHeight) const;
+	// Samples input, rendered at GetRenderSize, and writes output at full size
+	void AddUpscalePass(RenderGraph& graph, RenderGraphResource input, RenderGraphResource output);
+
+	void SetEnabled(bool enabled); // Disabled renders at the maximum scale
+	void SetScaleRange(float minScale, float maxScale);
+	inline void SetTargetMilliseconds(float milliseconds) { m_TargetMilliseconds = milliseconds; }
+	inline void SetSharpness(float sharpness) { m_Sharpness = sharpness; } // 0 is plain bilinear, 1 the strongest
+
+	inline bool IsEnabled() const { return m_Enabled; }
+	inline float GetScale() const { return m_Scale; }
+	inline float GetSharpness() const { return m_Sharpness; }
+	inline float GetGpuMilliseconds() const { return m_FrameTimer.GetMilliseconds(); }
+};
\ No newline at end of file
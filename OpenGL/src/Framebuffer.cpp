@@ -0,0 +1,308 @@
+#include "Framebuffer.h"
+
+#include <iostream>
+
+static bool HasStencil(unsigned int depthFormat) {
+	return depthFormat == GL_DEPTH24_STENCIL8 || depthFormat == GL_DEPTH32F_STENCIL8;
+}
+
+static unsigned int GetDepthAttachmentPoint(unsigned int depthFormat) {
+	return HasStencil(depthFormat) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+}
+
+// glTexImage2D wants a client format even without data, any one compatible with the internal format
+static void GetTransferFormat(unsigned int internalFormat, unsigned int& format, unsigned int& type) {
+	switch (internalFormat) {
+	case GL_DEPTH24_STENCIL8: format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; break;
+	case GL_DEPTH32F_STENCIL8: format = GL_DEPTH_STENCIL; type = GL_FLOAT_32_UNSIGNED_INT_24_8_REV; break;
+	case GL_DEPTH_COMPONENT16:
+	case GL_DEPTH_COMPONENT24:
+	case GL_DEPTH_COMPONENT32F: format = GL_DEPTH_COMPONENT; type = GL_FLOAT; break;
+	// Integer formats only accept the *_INTEGER formats with an integer type
+	case GL_R8UI:     format = GL_RED_INTEGER; type = GL_UNSIGNED_BYTE; break;
+	case GL_R8I:      format = GL_RED_INTEGER; type = GL_BYTE; break;
+	case GL_R16UI:    format = GL_RED_INTEGER; type = GL_UNSIGNED_SHORT; break;
+	case GL_R16I:     format = GL_RED_INTEGER; type = GL_SHORT; break;
+	case GL_R32UI:    format = GL_RED_INTEGER; type = GL_UNSIGNED_INT; break;
+	case GL_R32I:     format = GL_RED_INTEGER; type = GL_INT; break;
+	case GL_RG8UI:    format = GL_RG_INTEGER; type = GL_UNSIGNED_BYTE; break;
+	case GL_RG8I:     format = GL_RG_INTEGER; type = GL_BYTE; break;
+	case GL_RG16UI:   format = GL_RG_INTEGER; type = GL_UNSIGNED_SHORT; break;
+	case GL_RG16I:    format = GL_RG_INTEGER; type = GL_SHORT; break;
+	case GL_RG32UI:   format = GL_RG_INTEGER; type = GL_UNSIGNED_INT; break;
+	case GL_RG32I:    format = GL_RG_INTEGER; type = GL_INT; break;
+	case GL_RGBA8UI:  format = GL_RGBA_INTEGER; type = GL_UNSIGNED_BYTE; break;
+	case GL_RGBA8I:   format = GL_RGBA_INTEGER; type = GL_BYTE; break;
+	case GL_RGBA16UI: format = GL_RGBA_INTEGER; type = GL_UNSIGNED_SHORT; break;
+	case GL_RGBA16I:  format = GL_RGBA_INTEGER; type = GL_SHORT; break;
+	case GL_RGBA32UI: format = GL_RGBA_INTEGER; type = GL_UNSIGNED_INT; break;
+	case GL_RGBA32I:  format = GL_RGBA_INTEGER; type = GL_INT; break;
+	case GL_RGB10_A2UI: format = GL_RGBA_INTEGER; type = GL_UNSIGNED_INT_2_10_10_10_REV; break;
+	default: format = GL_RGBA; type = GL_FLOAT; break;
+	}
+}
+
+static bool IsIntegerTransferFormat(unsigned int format) {
+	return format == GL_RED_INTEGER || format == GL_RG_INTEGER || format == GL_RGBA_INTEGER;
+}
+
+Framebuffer::Framebuffer(const FramebufferSpec& spec)
+	: m_RendererID(0), m_ColorAttachment(0), m_DepthAttachment(0), m_Spec(spec), m_Complete(false)
+{
+	if (m_Spec.samples < 1) {
+		m_Spec.samples = 1;
+	}
+	if (GLHasDirectStateAccess()) {
+		Create();
+	}
+	else {
+		CreateBound();
+	}
+	if (!m_Complete) {
+		std::cerr << "Framebuffer " << m_Spec.width << "x" << m_Spec.height << " (" << m_Spec.samples << " samples) is incomplete!" << std::endl;
+	}
+}
+
+void Framebuffer::Create() {
+	GLCall(glCreateFramebuffers(1, &m_RendererID));
+	const bool multisampled = m_Spec.samples > 1;
+
+	if (m_Spec.colorFormat) {
+		if (multisampled) {
+			GLCall(glCreateRenderbuffers(1, &m_ColorAttachment));
+			GLCall(glNamedRenderbufferStorageMultisample(m_ColorAttachment, m_Spec.samples, m_Spec.colorFormat, m_Spec.width, m_Spec.height));
+			GLCall(glNamedFramebufferRenderbuffer(m_RendererID, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+		}
+		else {
+			unsigned int format, type;
+			GetTransferFormat(m_Spec.colorFormat, format, type);
+			const int filter = IsIntegerTransferFormat(format) ? GL_NEAREST : GL_LINEAR; // Integer textures are incomplete with linear filtering
+			GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_ColorAttachment));
+			GLCall(glTextureParameteri(m_ColorAttachment, GL_TEXTURE_MIN_FILTER, filter));
+			GLCall(glTextureParameteri(m_ColorAttachment, GL_TEXTURE_MAG_FILTER, filter));
+			GLCall(glTextureParameteri(m_ColorAttachment, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GLCall(glTextureParameteri(m_ColorAttachment, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			GLCall(glTextureStorage2D(m_ColorAttachment, 1, m_Spec.colorFormat, m_Spec.width, m_Spec.height));
+			GLCall(glNamedFramebufferTexture(m_RendererID, GL_COLOR_ATTACHMENT0, m_ColorAttachment, 0));
+		}
+	}
+	else {
+		GLCall(glNamedFramebufferDrawBuffer(m_RendererID, GL_NONE)); // Depth only
+		GLCall(glNamedFramebufferReadBuffer(m_RendererID, GL_NONE));
+	}
+
+	if (m_Spec.depthFormat) {
+		const unsigned int attachment = GetDepthAttachmentPoint(m_Spec.depthFormat);
+		if (multisampled) {
+			GLCall(glCreateRenderbuffers(1, &m_DepthAttachment));
+			GLCall(glNamedRenderbufferStorageMultisample(m_DepthAttachment, m_Spec.samples, m_Spec.depthFormat, m_Spec.width, m_Spec.height));
+			GLCall(glNamedFramebufferRenderbuffer(m_RendererID, attachment, GL_RENDERBUFFER, m_DepthAttachment));
+		}
+		else {
+			GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_DepthAttachment));
+			GLCall(glTextureParameteri(m_DepthAttachment, GL_TEXTURE_MIN_FILTER, GL_NEAREST)); // Depth is never filtered
+			GLCall(glTextureParameteri(m_DepthAttachment, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+			GLCall(glTextureParameteri(m_DepthAttachment, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GLCall(glTextureParameteri(m_DepthAttachment, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			GLCall(glTextureStorage2D(m_DepthAttachment, 1, m_Spec.depthFormat, m_Spec.width, m_Spec.height));
+			GLCall(glNamedFramebufferTexture(m_RendererID, attachment, m_DepthAttachment, 0));
+		}
+	}
+
+	GLCall(m_Complete = glCheckNamedFramebufferStatus(m_RendererID, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+}
+
+void Framebuffer::CreateBound() {
+	GLCall(glGenFramebuffers(1, &m_RendererID));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	const bool multisampled = m_Spec.samples > 1;
+
+	unsigned int format, type;
+	if (m_Spec.colorFormat) {
+		if (multisampled) {
+			GLCall(glGenRenderbuffers(1, &m_ColorAttachment));
+			GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorAttachment));
+			GLCall(glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_Spec.samples, m_Spec.colorFormat, m_Spec.width, m_Spec.height));
+			GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+		}
+		else {
+			GetTransferFormat(m_Spec.colorFormat, format, type);
+			GLCall(glGenTextures(1, &m_ColorAttachment));
+			GLCall(glBindTexture(GL_TEXTURE_2D, m_ColorAttachment));
+			const int filter = IsIntegerTransferFormat(format) ? GL_NEAREST : GL_LINEAR;
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			GLCall(glTexImage2D(GL_TEXTURE_2D, 0, m_Spec.colorFormat, m_Spec.width, m_Spec.height, 0, format, type, nullptr));
+			GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_ColorAttachment, 0));
+		}
+	}
+	else {
+		GLCall(glDrawBuffer(GL_NONE)); // Depth only
+		GLCall(glReadBuffer(GL_NONE));
+	}
+
+	if (m_Spec.depthFormat) {
+		const unsigned int attachment = GetDepthAttachmentPoint(m_Spec.depthFormat);
+		if (multisampled) {
+			GLCall(glGenRenderbuffers(1, &m_DepthAttachment));
+			GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment));
+			GLCall(glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_Spec.samples, m_Spec.depthFormat, m_Spec.width, m_Spec.height));
+			GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, m_DepthAttachment));
+		}
+		else {
+			GetTransferFormat(m_Spec.depthFormat, format, type);
+			GLCall(glGenTextures(1, &m_DepthAttachment));
+			GLCall(glBindTexture(GL_TEXTURE_2D, m_DepthAttachment));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST)); // Depth is never filtered
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			GLCall(glTexImage2D(GL_TEXTURE_2D, 0, m_Spec.depthFormat, m_Spec.width, m_Spec.height, 0, format, type, nullptr));
+			GLCall(glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, m_DepthAttachment, 0));
+		}
+	}
+
+	GLCall(m_Complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+Framebuffer::~Framebuffer() {
+	Release();
+}
+
+void Framebuffer::Release() {
+	if (m_Spec.samples > 1) {
+		GLCall(glDeleteRenderbuffers(1, &m_ColorAttachment));
+		GLCall(glDeleteRenderbuffers(1, &m_DepthAttachment));
+	}
+	else {
+		GLCall(glDeleteTextures(1, &m_ColorAttachment));
+		GLCall(glDeleteTextures(1, &m_DepthAttachment));
+	}
+	GLCall(glDeleteFramebuffers(1, &m_RendererID)); // Deleting 0 is a no-op
+	m_RendererID = m_ColorAttachment = m_DepthAttachment = 0;
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_ColorAttachment(other.m_ColorAttachment), m_DepthAttachment(other.m_DepthAttachment),
+	m_Spec(other.m_Spec), m_Complete(other.m_Complete)
+{
+	other.m_RendererID = other.m_ColorAttachment = other.m_DepthAttachment = 0; // The moved-from target deletes nothing
+}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept {
+	if (this != &other) {
+		Release(); // Release the target we are replacing
+		m_RendererID = other.m_RendererID;
+		m_ColorAttachment = other.m_ColorAttachment;
+		m_DepthAttachment = other.m_DepthAttachment;
+		m_Spec = other.m_Spec;
+		m_Complete = other.m_Complete;
+		other.m_RendererID = other.m_ColorAttachment = other.m_DepthAttachment = 0;
+	}
+	return *this;
+}
+
+void Framebuffer::Bind() const {
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glViewport(0, 0, m_Spec.width, m_Spec.height));
+}
+
+void Framebuffer::BindDefault(int width, int height) {
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+	GLCall(glViewport(0, 0, width, height));
+}
+
+unsigned int Framebuffer::GetBlitMask(const Framebuffer& target) const {
+	unsigned int mask = 0;
+	if (m_ColorAttachment && target.m_ColorAttachment) {
+		mask |= GL_COLOR_BUFFER_BIT;
+	}
+	if (m_DepthAttachment && target.m_DepthAttachment) {
+		mask |= GL_DEPTH_BUFFER_BIT;
+		if (HasStencil(m_Spec.depthFormat) && HasStencil(target.m_Spec.depthFormat)) {
+			mask |= GL_STENCIL_BUFFER_BIT;
+		}
+	}
+	return mask;
+}
+
+void Framebuffer::Resolve(const Framebuffer& target) const {
+	// Depth and stencil only blit with NEAREST, and a multisample resolve copies 1:1 anyway
+	const unsigned int mask = GetBlitMask(target);
+	if (GLHasDirectStateAccess()) {
+		GLCall(glBlitNamedFramebuffer(m_RendererID, target.m_RendererID, 0, 0, m_Spec.width, m_Spec.height,
+			0, 0, target.m_Spec.width, target.m_Spec.height, mask, GL_NEAREST));
+		return;
+	}
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.m_RendererID));
+	GLCall(glBlitFramebuffer(0, 0, m_Spec.width, m_Spec.height, 0, 0, target.m_Spec.width, target.m_Spec.height, mask, GL_NEAREST));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::BlitToDefault(int width, int height) const {
+	// A scaled single-sample copy can filter, a multisample resolve must be 1:1
+	const unsigned int filter = m_Spec.samples > 1 ? GL_NEAREST : GL_LINEAR;
+	if (GLHasDirectStateAccess()) {
+		GLCall(glBlitNamedFramebuffer(m_RendererID, 0, 0, 0, m_Spec.width, m_Spec.height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, filter));
+		return;
+	}
+	GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+	GLCall(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+	GLCall(glBlitFramebuffer(0, 0, m_Spec.width, m_Spec.height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, filter));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::Discard(bool color, bool depth) const {
+	if (!CanDiscard()) {
+		return;
+	}
+	unsigned int attachments[2];
+	int count = 0;
+	if (color && m_ColorAttachment) {
+		attachments[count++] = GL_COLOR_ATTACHMENT0;
+	}
+	if (depth && m_DepthAttachment) {
+		attachments[count++] = GetDepthAttachmentPoint(m_Spec.depthFormat);
+	}
+	if (count == 0) {
+		return;
+	}
+	if (GLHasDirectStateAccess()) {
+		GLCall(glInvalidateNamedFramebufferData(m_RendererID, count, attachments));
+		return;
+	}
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+	GLCall(glInvalidateFramebuffer(GL_FRAMEBUFFER, count, attachments));
+	GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::BindColorTexture(unsigned int slot) const {
+	ASSERT(m_Spec.samples == 1); // Resolve multisampled targets first
+	if (GLHasDirectStateAccess()) {
+		GLCall(glBindTextureUnit(slot, m_ColorAttachment));
+		return;
+	}
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_ColorAttachment));
+}
+
+void Framebuffer::BindDepthTexture(unsigned int slot) const {
+	ASSERT(m_Spec.samples == 1);
+	if (GLHasDirectStateAccess()) {
+		GLCall(glBindTextureUnit(slot, m_DepthAttachment));
+		return;
+	}
+	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+	GLCall(glBindTexture(GL_TEXTURE_2D, m_DepthAttachment));
+}
+
+bool Framebuffer::CanDiscard() {
+	static const bool supported = GLEW_VERSION_4_3 || GLEW_ARB_invalidate_subdata; // Queried once, after glewInit
+	return supported;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Renderer.h"
+
+// Texture unit full-screen passes read targets through. GL 3.3 guarantees 16 fragment units and
+// material textures are bound from 0 up, so sampling a target never replaces a scene texture.
+const unsigned int TARGET_TEXTURE_SLOT = 15;
+
+struct FramebufferSpec {
+	int width = 0;
+	int height = 0;
+	unsigned int colorFormat = GL_RGBA8; // 0 for a depth-only target
+	unsigned int depthFormat = GL_DEPTH24_STENCIL8; // 0 for a color-only target
+	unsigned int samples = 1; // More than 1 renders to multisampled renderbuffers, Resolve them to read the result
+
+	inline bool operator==(const FramebufferSpec& other) const {
+		return width == other.width && height == other.height && colorFormat == other.colorFormat
+			&& depthFormat == other.depthFormat && samples == other.samples;
+	}
+	inline bool operator!=(const FramebufferSpec& other) const { return !(*this == other); }
+};
+
+// Offscreen render target with one color and one depth attachment. Single-sample attachments
+// are textures, so later passes can sample them; multisampled ones are renderbuffers that
+// Resolve or BlitToDefault copy into a single-sample target. Discard tells the driver the
+// contents are not needed any more (glInvalidateFramebuffer, GL 4.3 / ARB_invalidate_subdata),
+// which saves the write-back of the attachments on tiled GPUs and is a no-op without it.
+class Framebuffer {
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment; // Texture, or renderbuffer when multisampled, 0 when absent
+	unsigned int m_DepthAttachment;
+	FramebufferSpec m_Spec;
+	bool m_Complete;
+public:
+	Framebuffer(const FramebufferSpec& spec);
+	~Framebuffer();
+
+	// The GL objects are owned, so it can move but never be copied
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+	Framebuffer(Framebuffer&& other) noexcept;
+	Framebuffer& operator=(Framebuffer&& other) noexcept;
+
+	void Bind() const; // Also sets the viewport to the target's size
+	static void BindDefault(int width, int height); // Back to the window
+
+	// Multisampled sources need a target of the same size. Copies every attachment both sides have.
+	void Resolve(const Framebuffer& target) const;
+	void BlitToDefault(int width, int height) const; // Color only, the window's size must match when multisampled
+	void Discard(bool color = true, bool depth = true) const;
+
+	// Single-sample targets only
+	void BindColorTexture(unsigned int slot = 0) const;
+	void BindDepthTexture(unsigned int slot = 0) const;
+
+	inline const FramebufferSpec& GetSpec() const { return m_Spec; }
+	inline int GetWidth() const { return m_Spec.width; }
+	inline int GetHeight() const { return m_Spec.height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsComplete() const { return m_Complete; }
+
+	static bool CanDiscard(); // GL 4.3 / ARB_invalidate_subdata
+private:
+	void Create(); // DSA path
+	void CreateBound(); // Bind-to-edit path for contexts without Direct State Access
+	unsigned int GetBlitMask(const Framebuffer& target) const;
+	void Release();
+};
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "GpuTimer.h"
+#include "Renderer.h"
+
+GpuTimer::GpuTimer()
+	: m_Next(0), m_Running(false), m_Milliseconds(0.0f), m_HasResult(false)
+{
+	GLCall(glGenQueries(LATENCY * 2, m_Queries));
+	for (unsigned int i = 0; i < LATENCY; i++) {
+		m_Pending[i] = false;
+	}
+}
+
+GpuTimer::~GpuTimer() {
+	GLCall(glDeleteQueries(LATENCY * 2, m_Queries));
+}
+
+void GpuTimer::Begin() {
+	Poll();
+	if (m_Pending[m_Next]) {
+		return; // The GPU is LATENCY frames behind, skip this measurement rather than wait
+	}
+	GLCall(glQueryCounter(m_Queries[m_Next * 2], GL_TIMESTAMP));
+	m_Running = true;
+}
+
+void GpuTimer::End() {
+	if (!m_Running) {
+		return;
+	}
+	GLCall(glQueryCounter(m_Queries[m_Next * 2 + 1], GL_TIMESTAMP));
+	m_Pending[m_Next] = true;
+	m_Next = (m_Next + 1) % LATENCY;
+	m_Running = false;
+}
+
+void GpuTimer::Poll() {
+	// m_Next is the oldest slot, results finish in submission order
+	for (unsigned int i = 0; i < LATENCY; i++) {
+		const unsigned int slot = (m_Next + i) % LATENCY;
+		if (!m_Pending[slot]) {
+			continue;
+		}
+		int available = 0;
+		GLCall(glGetQueryObjectiv(m_Queries[slot * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available));
+		if (!available) {
+			return; // Newer slots are not done either
+		}
+		GLuint64 begin = 0, end = 0;
+		GLCall(glGetQueryObjectui64v(m_Queries[slot * 2], GL_QUERY_RESULT, &begin));
+		GLCall(glGetQueryObjectui64v(m_Queries[slot * 2 + 1], GL_QUERY_RESULT, &end));
+		m_Milliseconds = (float)((double)(end - begin) * 1e-6); // Nanoseconds
+		m_HasResult = true;
+		m_Pending[slot] = false;
+	}
+}
\ No newline at end of file
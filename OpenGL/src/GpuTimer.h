@@ -0,0 +1,32 @@
+#pragma once
+
+// Measures GPU time between Begin and End with timestamp queries (GL 3.3 / ARB_timer_query).
+// Results arrive a few frames late, so the timer cycles through LATENCY query pairs and only
+// reads a pair once it is available; it never stalls the pipeline. Timestamps rather than
+// GL_TIME_ELAPSED, so timers can nest and overlap, e.g. per pass inside a whole-frame timer.
+class GpuTimer {
+private:
+	static const unsigned int LATENCY = 4; // Frames a result may be late before a measurement is skipped
+
+	unsigned int m_Queries[LATENCY * 2]; // Begin and end timestamp per frame in flight
+	bool m_Pending[LATENCY];
+	unsigned int m_Next;
+	bool m_Running; // Begin issued a query and End has to close it
+	float m_Milliseconds;
+	bool m_HasResult;
+public:
+	GpuTimer();
+	~GpuTimer();
+
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+
+	void Begin();
+	void End();
+
+	// Latest finished measurement, 0 until the first one arrives
+	inline float GetMilliseconds() const { return m_Milliseconds; }
+	inline bool HasResult() const { return m_HasResult; }
+private:
+	void Poll(); // Reads every finished measurement, oldest first
+};
\ No newline at end of file
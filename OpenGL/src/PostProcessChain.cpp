@@ -0,0 +1,197 @@
+#include "PostProcessChain.h"
+
+// Three vertices from gl_VertexID cover the screen with one triangle, no diagonal seam
+static const char* FULLSCREEN_VERTEX_SHADER = R"(#shader vertex
+#version 330 core
+
+out vec2 v_TexCoord;
+
+void main() {
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    v_TexCoord = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
+
+)";
+
+PostProcessChain::PostProcessChain()
+	: m_Dirty(true)
+{
+}
+
+unsigned int PostProcessChain::AddEffect(const PostEffect& effect) {
+	m_Effects.push_back(effect);
+	m_Dirty = true;
+	return (unsigned int)m_Effects.size() - 1;
+}
+
+void PostProcessChain::SetEnabled(unsigned int effect, bool enabled) {
+	if (m_Effects[effect].enabled != enabled) {
+		m_Effects[effect].enabled = enabled;
+		m_Dirty = true; // Stages and their shaders change with the set of effects
+	}
+}
+
+void PostProcessChain::SetParameter(unsigned int effect, const std::string& name, float value) {
+	for (auto& parameter : m_Effects[effect].parameters) {
+		if (parameter.first == name) {
+			parameter.second = value;
+			return;
+		}
+	}
+	m_Effects[effect].parameters.push_back({ name, value });
+}
+
+unsigned int PostProcessChain::GetPassCount() {
+	Build();
+	return (unsigned int)m_Stages.size();
+}
+
+void PostProcessChain::Build() {
+	if (!m_Dirty) {
+		return;
+	}
+	m_Stages.clear();
+	for (unsigned int i = 0; i < m_Effects.size(); i++) {
+		const PostEffect& effect = m_Effects[i];
+		if (!effect.enabled) {
+			continue;
+		}
+		// A neighborhood effect needs the finished image, per-pixel ones ride along in the current pass
+		if (m_Stages.empty() || effect.neighborhood) {
+			m_Stages.push_back({ "", {}, nullptr, effect.neighborhood });
+		}
+		Stage& stage = m_Stages.back();
+		stage.name += (stage.name.empty() ? "" : "+") + effect.name;
+		stage.effects.push_back(i);
+	}
+	if (m_Stages.empty()) {
+		m_Stages.push_back({ "Copy", {}, nullptr, false }); // Nothing enabled, the input still has to reach the output
+	}
+
+	for (unsigned int s = 0; s < m_Stages.size(); s++) {
+		m_Stages[s].shader.reset(new Shader(Shader::FromSource("post:" + m_Stages[s].name, GenerateSource(s))));
+	}
+	m_Dirty = false;
+}
+
+std::string PostProcessChain::GenerateSource(unsigned int stage) const {
+	const Stage& current = m_Stages[stage];
+	std::string source = FULLSCREEN_VERTEX_SHADER;
+	source += "#shader fragment\n#version 330 core\n\n";
+	source += "layout(location = 0) out vec4 o_Color;\n\nin vec2 v_TexCoord;\n\n";
+	source += "uniform sampler2D u_Input;\nuniform vec2 u_TexelSize;\n\n";
+	for (unsigned int effect : current.effects) {
+		source += "// " + m_Effects[effect].name + "\n" + m_Effects[effect].declarations + "\n";
+	}
+
+	source += "void main() {\n    vec2 uv = v_TexCoord;\n    vec4 color;\n";
+	if (!current.neighborhood) {
+		source += "    color = texture(u_Input, uv);\n";
+	}
+	for (unsigned int effect : current.effects) {
+		// Own scope per effect, so their locals never clash
+		source += "    { // " + m_Effects[effect].name + "\n" + m_Effects[effect].code + "\n    }\n";
+	}
+	source += "    o_Color = color;\n}\n";
+	return source;
+}
+
+void PostProcessChain::AddPasses(RenderGraph& graph, RenderGraphResource input, RenderGraphResource output, const FramebufferSpec& spec) {
+	Build();
+	RenderGraphResource source = input;
+	for (unsigned int s = 0; s < m_Stages.size(); s++) {
+		const bool last = s + 1 == m_Stages.size();
+		RenderGraphResource target = last ? output : graph.CreateTarget("Post " + std::to_string(s), spec);
+		graph.AddPass(m_Stages[s].name, [this, s, source](const Renderer& renderer, const RenderGraph& graph) {
+			Draw(renderer, s, *graph.GetTarget(source));
+		}).Read(source).Write(target);
+		source = target;
+	}
+}
+
+void PostProcessChain::Draw(const Renderer& renderer, unsigned int stage, const Framebuffer& input) {
+	Stage& current = m_Stages[stage];
+	Shader& shader = *current.shader;
+
+	// Every pixel is overwritten, nothing to test against or blend with
+	GLCall(glDisable(GL_DEPTH_TEST));
+	GLCall(glDisable(GL_BLEND));
+
+	shader.Bind();
+	input.BindColorTexture(TARGET_TEXTURE_SLOT);
+	shader.SetUniform1i("u_Input", TARGET_TEXTURE_SLOT);
+	if (current.neighborhood) {
+		shader.SetUniform2f("u_TexelSize", 1.0f / input.GetWidth(), 1.0f / input.GetHeight()); // Optimized out of per-pixel stages
+	}
+	for (unsigned int effect : current.effects) {
+		for (const auto& parameter : m_Effects[effect].parameters) {
+			shader.SetUniform1f(parameter.first, parameter.second);
+		}
+	}
+	renderer.DrawFullscreen(m_EmptyArray, shader);
+}
+
+PostEffect PostProcessChain::ToneMap(float exposure) {
+	PostEffect effect;
+	effect.name = "ToneMap";
+	effect.declarations = "uniform float u_Exposure;\n";
+	// Narkowicz's fit of the ACES reference curve
+	effect.code =
+		"        vec3 x = color.rgb * u_Exposure;\n"
+		"        color.rgb = clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);";
+	effect.parameters.push_back({ "u_Exposure", exposure });
+	return effect;
+}
+
+PostEffect PostProcessChain::ColorGrade(float contrast, float saturation) {
+	PostEffect effect;
+	effect.name = "ColorGrade";
+	effect.declarations = "uniform float u_Contrast;\nuniform float u_Saturation;\n";
+	effect.code =
+		"        float luma = dot(color.rgb, vec3(0.2126, 0.7152, 0.0722));\n"
+		"        color.rgb = mix(vec3(luma), color.rgb, u_Saturation);\n"
+		"        color.rgb = clamp((color.rgb - 0.5) * u_Contrast + 0.5, 0.0, 1.0);";
+	effect.parameters.push_back({ "u_Contrast", contrast });
+	effect.parameters.push_back({ "u_Saturation", saturation });
+	return effect;
+}
+
+PostEffect PostProcessChain::Vignette(float strength, float radius) {
+	PostEffect effect;
+	effect.name = "Vignette";
+	effect.declarations = "uniform float u_VignetteStrength;\nuniform float u_VignetteRadius;\n";
+	effect.code =
+		"        float edge = smoothstep(u_VignetteRadius - 0.25, u_VignetteRadius, distance(uv, vec2(0.5)));\n"
+		"        color.rgb *= 1.0 - u_VignetteStrength * edge;";
+	effect.parameters.push_back({ "u_VignetteStrength", strength });
+	effect.parameters.push_back({ "u_VignetteRadius", radius });
+	return effect;
+}
+
+PostEffect PostProcessChain::Fxaa() {
+	PostEffect effect;
+	effect.name = "FXAA";
+	effect.neighborhood = true;
+	// Lottes' FXAA without the end-of-edge search: blur along the local edge direction,
+	// and fall back to the narrower blur when the wider one leaves the neighborhood's range
+	effect.code =
+		"        const vec3 lumaWeights = vec3(0.299, 0.587, 0.114);\n"
+		"        vec4 center = texture(u_Input, uv);\n"
+		"        float lumaNW = dot(texture(u_Input, uv + vec2(-1.0, -1.0) * u_TexelSize).rgb, lumaWeights);\n"
+		"        float lumaNE = dot(texture(u_Input, uv + vec2(1.0, -1.0) * u_TexelSize).rgb, lumaWeights);\n"
+		"        float lumaSW = dot(texture(u_Input, uv + vec2(-1.0, 1.0) * u_TexelSize).rgb, lumaWeights);\n"
+		"        float lumaSE = dot(texture(u_Input, uv + vec2(1.0, 1.0) * u_TexelSize).rgb, lumaWeights);\n"
+		"        float lumaM = dot(center.rgb, lumaWeights);\n"
+		"        float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));\n"
+		"        float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));\n"
+		"        vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));\n"
+		"        float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25 / 8.0), 1.0 / 128.0);\n"
+		"        float rcpDirMin = 1.0 / (min(abs(dir.x), abs(dir.y)) + dirReduce);\n"
+		"        dir = clamp(dir * rcpDirMin, vec2(-8.0), vec2(8.0)) * u_TexelSize;\n"
+		"        vec3 rgbA = 0.5 * (texture(u_Input, uv + dir * (1.0 / 3.0 - 0.5)).rgb + texture(u_Input, uv + dir * (2.0 / 3.0 - 0.5)).rgb);\n"
+		"        vec3 rgbB = rgbA * 0.5 + 0.25 * (texture(u_Input, uv - dir * 0.5).rgb + texture(u_Input, uv + dir * 0.5).rgb);\n"
+		"        float lumaB = dot(rgbB, lumaWeights);\n"
+		"        color = vec4((lumaB < lumaMin || lumaB > lumaMax) ? rgbA : rgbB, center.a);";
+	return effect;
+}
\ No newline at end of file
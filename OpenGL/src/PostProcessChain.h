@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Shader.h"
+#include "RenderGraph.h"
+
+// One step of the post stack as GLSL pieces that PostProcessChain pastes into a generated shader.
+// Per-pixel code gets vec4 color and vec2 uv and changes color in place. Neighborhood code sets
+// color by sampling u_Input around uv, u_TexelSize being one texel, and must open its stage.
+struct PostEffect {
+	std::string name;
+	bool neighborhood = false; // Reads other pixels of its input, so it starts a pass of its own
+	std::string declarations; // Uniforms and helper functions
+	std::string code;
+	std::vector<std::pair<std::string, float>> parameters; // Float uniforms, set on every draw
+	bool enabled = true;
+};
+
+// Runs a post stack as few full-screen passes as its effects allow. Consecutive per-pixel
+// effects are fused into one generated fragment shader, compiled through Shader::FromSource, so
+// the image is read and written once for all of them; only a neighborhood effect (FXAA, blurs)
+// needs the finished image of what came before and starts a new pass. Tone map, grade,
+// vignette and FXAA run in 2 passes instead of 4. Shaders are regenerated when effects are
+// toggled, and the passes go into a RenderGraph with their intermediates as transient targets.
+class PostProcessChain {
+private:
+	struct Stage {
+		std::string name; // Its effects joined by '+'
+		std::vector<unsigned int> effects;
+		std::unique_ptr<Shader> shader;
+		bool neighborhood;
+	};
+
+	std::vector<PostEffect> m_Effects;
+	std::vector<Stage> m_Stages;
+	VertexArray m_EmptyArray; // The full-screen triangle has no vertex data
+	bool m_Dirty;
+public:
+	PostProcessChain();
+
+	PostProcessChain(const PostProcessChain&) = delete;
+	PostProcessChain& operator=(const PostProcessChain&) = delete;
+
+	unsigned int AddEffect(const PostEffect& effect); // Effects run in the order they are added
+	void SetEnabled(unsigned int effect, bool enabled);
+	void SetParameter(unsigned int effect, const std::string& name, float value);
+
+	// Reads input, a single-sample target, and writes output. Intermediates between passes use
+	// spec. The chain must outlive the graph's Execute.
+	void AddPasses(RenderGraph& graph, RenderGraphResource input, RenderGraphResource output, const FramebufferSpec& spec);
+
+	inline const PostEffect& GetEffect(unsigned int effect) const { return m_Effects[effect]; }
+	inline unsigned int GetEffectCount() const { return (unsigned int)m_Effects.size(); }
+	unsigned int GetPassCount(); // Full-screen passes for the enabled effects, at least 1
+	std::string GenerateSource(unsigned int stage) const; // The generated "#shader" source, for debugging
+
+	// Built-in effects
+	static PostEffect ToneMap(float exposure = 1.0f); // ACES filmic curve, HDR to [0, 1]
+	static PostEffect ColorGrade(float contrast = 1.0f, float saturation = 1.0f);
+	static PostEffect Vignette(float strength = 0.5f, float radius = 0.75f);
+	static PostEffect Fxaa(); // Neighborhood, run it on tone-mapped colors
+private:
+	void Build(); // Splits the enabled effects into stages and compiles their shaders
+	void Draw(const Renderer& renderer, unsigned int stage, const Framebuffer& input);
+};
\ No newline at end of file
@@ -0,0 +1,430 @@
+#include "RenderGraph.h"
+#include "RenderTargetPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+
+static const unsigned int NO_SLOT = 0xFFFFFFFF;
+
+static unsigned int GetBarrierBits(RenderGraphAccess access) {
+	switch (access) {
+	case RenderGraphAccess::Attachment: return GL_FRAMEBUFFER_BARRIER_BIT;
+	case RenderGraphAccess::Sampled: return GL_TEXTURE_FETCH_BARRIER_BIT;
+	case RenderGraphAccess::Storage: return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT;
+	case RenderGraphAccess::Indirect: return GL_COMMAND_BARRIER_BIT;
+	case RenderGraphAccess::Vertex: return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT;
+	}
+	return GL_ALL_BARRIER_BITS;
+}
+
+static const char* GetAccessName(RenderGraphAccess access) {
+	switch (access) {
+	case RenderGraphAccess::Attachment: return "attachment";
+	case RenderGraphAccess::Sampled: return "sampled";
+	case RenderGraphAccess::Storage: return "storage";
+	case RenderGraphAccess::Indirect: return "indirect";
+	case RenderGraphAccess::Vertex: return "vertex";
+	}
+	return "?";
+}
+
+// Estimate for the dump, drivers may pad
+static unsigned int GetBytesPerPixel(unsigned int format) {
+	switch (format) {
+	case 0: return 0;
+	case GL_R8: return 1;
+	case GL_RG8:
+	case GL_R16F:
+	case GL_DEPTH_COMPONENT16: return 2;
+	case GL_RGBA16F:
+	case GL_RG32F:
+	case GL_DEPTH32F_STENCIL8: return 8;
+	case GL_RGBA32F: return 16;
+	default: return 4;
+	}
+}
+
+static double GetMegabytes(const FramebufferSpec& spec) {
+	const double bytes = (double)spec.width * spec.height * spec.samples * (GetBytesPerPixel(spec.colorFormat) + GetBytesPerPixel(spec.depthFormat));
+	return bytes / (1024.0 * 1024.0);
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(RenderGraphResource resource, RenderGraphAccess access) {
+	m_Graph.m_Passes[m_Pass].reads.push_back({ resource.index, access });
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(RenderGraphResource resource, RenderGraphAccess access) {
+	m_Graph.m_Passes[m_Pass].writes.push_back({ resource.index, access });
+	m_Graph.m_Resources[resource.index].writers.push_back(m_Pass);
+	return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::SetSideEffect() {
+	m_Graph.m_Passes[m_Pass].sideEffect = true;
+	return *this;
+}
+
+RenderGraph::RenderGraph(RenderTargetPool& targets)
+	: m_Targets(targets), m_Compiled(false)
+{
+}
+
+RenderGraphResource RenderGraph::AddResource(const std::string& name, ResourceKind kind) {
+	Resource resource;
+	resource.name = name;
+	resource.kind = kind;
+	resource.target = nullptr;
+	resource.buffer = nullptr;
+	resource.firstUse = resource.lastUse = 0;
+	resource.slot = NO_SLOT;
+	m_Resources.push_back(resource);
+
+	RenderGraphResource handle;
+	handle.index = (unsigned int)m_Resources.size() - 1;
+	return handle;
+}
+
+RenderGraphResource RenderGraph::CreateTarget(const std::string& name, const FramebufferSpec& spec) {
+	RenderGraphResource handle = AddResource(name, ResourceKind::Transient);
+	m_Resources[handle.index].spec = spec;
+	return handle;
+}
+
+RenderGraphResource RenderGraph::ImportTarget(const std::string& name, Framebuffer& target) {
+	RenderGraphResource handle = AddResource(name, ResourceKind::Imported);
+	m_Resources[handle.index].spec = target.GetSpec();
+	m_Resources[handle.index].target = &target;
+	return handle;
+}
+
+RenderGraphResource RenderGraph::ImportWindow(const std::string& name, int width, int height) {
+	RenderGraphResource handle = AddResource(name, ResourceKind::Window);
+	m_Resources[handle.index].spec.width = width;
+	m_Resources[handle.index].spec.height = height;
+	return handle;
+}
+
+RenderGraphResource RenderGraph::ImportBuffer(const std::string& name, const VertexBuffer& buffer) {
+	RenderGraphResource handle = AddResource(name, ResourceKind::Buffer);
+	m_Resources[handle.index].buffer = &buffer;
+	return handle;
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(const std::string& name, const ExecuteFunction& execute) {
+	Pass pass;
+	pass.name = name;
+	pass.execute = execute;
+	pass.sideEffect = false;
+	pass.alive = false;
+	pass.barrier = 0;
+	m_Passes.push_back(pass);
+	m_Compiled = false;
+	return PassBuilder(*this, (unsigned int)m_Passes.size() - 1);
+}
+
+bool RenderGraph::Compile() {
+	Cull();
+	if (!Sort()) {
+		return false;
+	}
+	AssignSlots();
+	PlaceBarriers();
+	m_Compiled = true;
+	return true;
+}
+
+void RenderGraph::Cull() {
+	// Anything that leaves the frame keeps its pass, and a kept pass keeps the writers of what it reads
+	std::vector<bool> needed(m_Resources.size(), false);
+	std::vector<unsigned int> work;
+	for (unsigned int i = 0; i < m_Passes.size(); i++) {
+		Pass& pass = m_Passes[i];
+		pass.alive = pass.sideEffect;
+		for (const Use& use : pass.writes) {
+			if (m_Resources[use.resource].kind != ResourceKind::Transient) {
+				pass.alive = true;
+			}
+		}
+		if (pass.alive) {
+			work.push_back(i);
+		}
+	}
+
+	while (!work.empty()) {
+		const Pass& pass = m_Passes[work.back()];
+		work.pop_back();
+		for (const Use& use : pass.reads) {
+			if (needed[use.resource]) {
+				continue;
+			}
+			needed[use.resource] = true;
+			for (unsigned int writer : m_Resources[use.resource].writers) {
+				if (!m_Passes[writer].alive) {
+					m_Passes[writer].alive = true;
+					work.push_back(writer);
+				}
+			}
+		}
+	}
+}
+
+bool RenderGraph::Sort() {
+	// Writers of a resource run in declaration order, and all of them before its plain readers
+	std::vector<std::vector<unsigned int>> successors(m_Passes.size());
+	std::vector<unsigned int> inDegree(m_Passes.size(), 0);
+	auto addEdge = [&](unsigned int from, unsigned int to) {
+		successors[from].push_back(to);
+		inDegree[to]++;
+	};
+
+	for (unsigned int r = 0; r < m_Resources.size(); r++) {
+		std::vector<unsigned int> writers;
+		for (unsigned int writer : m_Resources[r].writers) {
+			if (m_Passes[writer].alive && (writers.empty() || writers.back() != writer)) {
+				writers.push_back(writer);
+			}
+		}
+		for (unsigned int i = 1; i < writers.size(); i++) {
+			addEdge(writers[i - 1], writers[i]);
+		}
+		for (unsigned int p = 0; p < m_Passes.size(); p++) {
+			const Pass& pass = m_Passes[p];
+			if (!pass.alive || std::find(writers.begin(), writers.end(), p) != writers.end()) {
+				continue; // A pass that also writes it reads what the earlier writers left
+			}
+			for (const Use& use : pass.reads) {
+				if (use.resource == r) {
+					for (unsigned int writer : writers) {
+						addEdge(writer, p);
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	// Kahn's algorithm, the lowest declaration index goes first among ready passes
+	std::priority_queue<unsigned int, std::vector<unsigned int>, std::greater<unsigned int>> ready;
+	unsigned int aliveCount = 0;
+	for (unsigned int p = 0; p < m_Passes.size(); p++) {
+		if (m_Passes[p].alive) {
+			aliveCount++;
+			if (inDegree[p] == 0) {
+				ready.push(p);
+			}
+		}
+	}
+
+	m_Order.clear();
+	while (!ready.empty()) {
+		const unsigned int p = ready.top();
+		ready.pop();
+		m_Order.push_back(p);
+		for (unsigned int next : successors[p]) {
+			if (--inDegree[next] == 0) {
+				ready.push(next);
+			}
+		}
+	}
+
+	if (m_Order.size() != aliveCount) {
+		std::cerr << "Render graph has a dependency cycle through:";
+		for (unsigned int p = 0; p < m_Passes.size(); p++) {
+			if (m_Passes[p].alive && inDegree[p] > 0) {
+				std::cerr << " " << m_Passes[p].name;
+			}
+		}
+		std::cerr << std::endl;
+		m_Order.clear();
+		return false;
+	}
+	return true;
+}
+
+void RenderGraph::AssignSlots() {
+	const unsigned int unused = 0xFFFFFFFF;
+	for (Resource& resource : m_Resources) {
+		resource.firstUse = unused;
+		resource.lastUse = 0;
+		resource.slot = NO_SLOT;
+	}
+	for (unsigned int i = 0; i < m_Order.size(); i++) {
+		const Pass& pass = m_Passes[m_Order[i]];
+		for (const std::vector<Use>* uses : { &pass.reads, &pass.writes }) {
+			for (const Use& use : *uses) {
+				Resource& resource = m_Resources[use.resource];
+				resource.firstUse = std::min(resource.firstUse, i);
+				resource.lastUse = std::max(resource.lastUse, i);
+			}
+		}
+	}
+
+	// Interval packing: a transient target takes over a slot of the same spec that is dead by its first pass
+	std::vector<unsigned int> transients;
+	for (unsigned int r = 0; r < m_Resources.size(); r++) {
+		if (m_Resources[r].kind == ResourceKind::Transient && m_Resources[r].firstUse != unused) {
+			transients.push_back(r);
+		}
+	}
+	std::sort(transients.begin(), transients.end(), [this](unsigned int a, unsigned int b) {
+		return m_Resources[a].firstUse < m_Resources[b].firstUse;
+	});
+
+	m_Slots.clear();
+	for (unsigned int r : transients) {
+		Resource& resource = m_Resources[r];
+		for (unsigned int s = 0; s < m_Slots.size(); s++) {
+			if (m_Slots[s].spec == resource.spec && m_Slots[s].lastUse < resource.firstUse) {
+				resource.slot = s;
+				m_Slots[s].lastUse = resource.lastUse;
+				break;
+			}
+		}
+		if (resource.slot == NO_SLOT) {
+			m_Slots.push_back({ resource.spec, resource.firstUse, resource.lastUse, nullptr });
+			resource.slot = (unsigned int)m_Slots.size() - 1;
+		}
+	}
+}
+
+void RenderGraph::PlaceBarriers() {
+	// Storage writes are the only incoherent ones, each later kind of access needs its own bit once
+	std::vector<unsigned int> outstanding(m_Resources.size(), 0); // Bits not yet issued since the last storage write
+	for (unsigned int p : m_Order) {
+		Pass& pass = m_Passes[p];
+		pass.barrier = 0;
+		for (const std::vector<Use>* uses : { &pass.reads, &pass.writes }) {
+			for (const Use& use : *uses) {
+				const unsigned int bits = outstanding[use.resource] & GetBarrierBits(use.access);
+				pass.barrier |= bits;
+			}
+		}
+		if (pass.barrier) {
+			for (unsigned int& bits : outstanding) {
+				bits &= ~pass.barrier; // glMemoryBarrier covers every resource
+			}
+		}
+		for (const Use& use : pass.writes) {
+			if (use.access == RenderGraphAccess::Storage) {
+				outstanding[use.resource] = GL_ALL_BARRIER_BITS;
+			}
+		}
+	}
+}
+
+void RenderGraph::Execute(const Renderer& renderer) {
+	if (!m_Compiled && !Compile()) {
+		return;
+	}
+
+	for (unsigned int i = 0; i < m_Order.size(); i++) {
+		Pass& pass = m_Passes[m_Order[i]];
+
+		for (Slot& slot : m_Slots) {
+			if (slot.firstUse == i) {
+				slot.target = &m_Targets.Acquire(slot.spec);
+			}
+		}
+		for (Resource& resource : m_Resources) {
+			if (resource.slot != NO_SLOT) {
+				resource.target = m_Slots[resource.slot].target;
+			}
+		}
+
+		if (pass.barrier) {
+			GLCall(glMemoryBarrier(pass.barrier));
+		}
+		for (const Use& use : pass.writes) {
+			if (use.access == RenderGraphAccess::Attachment) {
+				const Resource& resource = m_Resources[use.resource];
+				if (resource.kind == ResourceKind::Window) {
+					Framebuffer::BindDefault(resource.spec.width, resource.spec.height);
+				}
+				else {
+					resource.target->Bind();
+				}
+				break; // One framebuffer per pass
+			}
+		}
+
+		Timing& timing = m_Timings[pass.name];
+		const auto start = std::chrono::high_resolution_clock::now();
+		timing.gpu.Begin();
+		pass.execute(renderer, *this);
+		timing.gpu.End();
+		timing.cpuMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		for (const Resource& resource : m_Resources) {
+			if (resource.slot != NO_SLOT && resource.lastUse == i && m_Slots[resource.slot].lastUse != i) {
+				resource.target->Discard(); // Dead, the next resource in the framebuffer starts over
+			}
+		}
+		for (Slot& slot : m_Slots) {
+			if (slot.lastUse == i) {
+				m_Targets.Release(*slot.target); // Nothing reads it after this pass
+				slot.target = nullptr;
+			}
+		}
+	}
+}
+
+void RenderGraph::Reset() {
+	m_Resources.clear();
+	m_Passes.clear();
+	m_Order.clear();
+	m_Slots.clear();
+	m_Compiled = false;
+}
+
+void RenderGraph::Dump(std::ostream& stream) const {
+	stream << "Render graph: " << m_Passes.size() << " passes, " << m_Order.size() << " executed" << std::endl;
+	stream << std::fixed << std::setprecision(3);
+	for (unsigned int i = 0; i < m_Order.size(); i++) {
+		const Pass& pass = m_Passes[m_Order[i]];
+		stream << "  " << i << " " << pass.name;
+		auto timing = m_Timings.find(pass.name);
+		if (timing != m_Timings.end()) {
+			stream << "  gpu " << timing->second.gpu.GetMilliseconds() << " ms, cpu " << timing->second.cpuMilliseconds << " ms";
+		}
+		if (pass.barrier) {
+			stream << "  barrier 0x" << std::hex << pass.barrier << std::dec;
+		}
+		stream << std::endl;
+		for (const Use& use : pass.reads) {
+			stream << "      reads  " << m_Resources[use.resource].name << " (" << GetAccessName(use.access) << ")" << std::endl;
+		}
+		for (const Use& use : pass.writes) {
+			stream << "      writes " << m_Resources[use.resource].name << " (" << GetAccessName(use.access) << ")" << std::endl;
+		}
+	}
+	for (const Pass& pass : m_Passes) {
+		if (!pass.alive) {
+			stream << "  culled " << pass.name << std::endl;
+		}
+	}
+
+	double aliased = 0.0, separate = 0.0;
+	for (const Slot& slot : m_Slots) {
+		aliased += GetMegabytes(slot.spec);
+	}
+	unsigned int transientCount = 0;
+	for (const Resource& resource : m_Resources) {
+		if (resource.slot != NO_SLOT) {
+			separate += GetMegabytes(resource.spec);
+			transientCount++;
+		}
+	}
+	stream << "Transient targets: " << transientCount << " in " << m_Slots.size() << " framebuffers, "
+		<< aliased << " MB (" << separate << " MB without aliasing)" << std::endl;
+	for (const Resource& resource : m_Resources) {
+		if (resource.slot != NO_SLOT) {
+			stream << "  " << resource.name << " " << resource.spec.width << "x" << resource.spec.height << " x" << resource.spec.samples
+				<< "  passes " << resource.firstUse << "-" << resource.lastUse << "  framebuffer " << resource.slot << std::endl;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Framebuffer.h"
+#include "GpuTimer.h"
+
+class RenderTargetPool;
+class VertexBuffer;
+
+// How a pass touches a resource, decides the barrier a following access needs
+enum class RenderGraphAccess {
+	Attachment, // Rendered to, the pass's framebuffer
+	Sampled, // Read through a sampler
+	Storage, // Image load/store or shader storage buffer, incoherent so later accesses need a barrier
+	Indirect, // Draw or dispatch parameters
+	Vertex // Vertex or index data
+};
+
+struct RenderGraphResource {
+	unsigned int index = 0xFFFFFFFF;
+};
+
+// Describes a frame as passes and the resources they read and write, then works out what the
+// frame actually needs: passes whose output never reaches an imported resource are culled, the
+// rest run in dependency order (declaration order between independent ones), and a glMemoryBarrier
+// goes before any pass that touches what an earlier pass wrote through Storage access.
+// Transient targets only live from their first to their last pass; ones with the same spec whose
+// lifetimes don't overlap share a framebuffer from the RenderTargetPool. Every write to a
+// resource lands before any read of it, so ping-ponging uses a second transient target, which
+// costs nothing once it aliases.
+// Rebuild the graph every frame: Reset, declare, Compile, Execute. Pass timings survive Reset.
+class RenderGraph {
+public:
+	typedef std::function<void(const Renderer& renderer, const RenderGraph& graph)> ExecuteFunction;
+
+	// Declares what the pass added last touches, e.g. graph.AddPass(...).Read(scene).Write(window)
+	class PassBuilder {
+	private:
+		RenderGraph& m_Graph;
+		unsigned int m_Pass;
+	public:
+		PassBuilder(RenderGraph& graph, unsigned int pass)
+			: m_Graph(graph), m_Pass(pass)
+		{
+		}
+
+		PassBuilder& Read(RenderGraphResource resource, RenderGraphAccess access = RenderGraphAccess::Sampled);
+		PassBuilder& Write(RenderGraphResource resource, RenderGraphAccess access = RenderGraphAccess::Attachment);
+		PassBuilder& SetSideEffect(); // Never culled, e.g. a readback
+	};
+private:
+	enum class ResourceKind { Transient, Imported, Window, Buffer };
+
+	struct Resource {
+		std::string name;
+		ResourceKind kind;
+		FramebufferSpec spec; // Transient targets, and the size of the window
+		Framebuffer* target; // Imported, or the pooled target while a transient one is alive
+		const VertexBuffer* buffer;
+		std::vector<unsigned int> writers; // Passes, in declaration order
+		unsigned int firstUse, lastUse; // Positions in m_Order
+		unsigned int slot; // Shared target of a transient resource
+	};
+
+	struct Use {
+		unsigned int resource;
+		RenderGraphAccess access;
+	};
+
+	struct Pass {
+		std::string name;
+		ExecuteFunction execute;
+		std::vector<Use> reads;
+		std::vector<Use> writes;
+		bool sideEffect;
+		bool alive;
+		unsigned int barrier; // glMemoryBarrier bits issued before it runs
+	};
+
+	struct Slot {
+		FramebufferSpec spec;
+		unsigned int firstUse, lastUse;
+		Framebuffer* target;
+	};
+
+	struct Timing {
+		GpuTimer gpu;
+		float cpuMilliseconds = 0.0f;
+	};
+
+	RenderTargetPool& m_Targets;
+	std::vector<Resource> m_Resources;
+	std::vector<Pass> m_Passes;
+	std::vector<unsigned int> m_Order; // Alive passes in execution order
+	std::vector<Slot> m_Slots;
+	std::map<std::string, Timing> m_Timings; // By pass name, so they carry over between frames
+	bool m_Compiled;
+public:
+	RenderGraph(RenderTargetPool& targets);
+
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	RenderGraphResource CreateTarget(const std::string& name, const FramebufferSpec& spec); // Transient, pooled
+	RenderGraphResource ImportTarget(const std::string& name, Framebuffer& target); // Outlives the frame, never culled
+	RenderGraphResource ImportWindow(const std::string& name, int width, int height); // The default framebuffer
+	RenderGraphResource ImportBuffer(const std::string& name, const VertexBuffer& buffer); // Only tracked for barriers
+
+	PassBuilder AddPass(const std::string& name, const ExecuteFunction& execute);
+
+	bool Compile(); // False on a dependency cycle
+	void Execute(const Renderer& renderer); // Binds each pass's attachment target before calling it
+	void Reset();
+
+	// Valid inside a pass, nullptr for the window
+	Framebuffer* GetTarget(RenderGraphResource resource) const { return m_Resources[resource.index].target; }
+	const VertexBuffer* GetBuffer(RenderGraphResource resource) const { return m_Resources[resource.index].buffer; }
+
+	// Execution order, culled passes, barriers, transient lifetimes and aliasing, pass timings
+	void Dump(std::ostream& stream) const;
+	inline unsigned int GetPassCount() const { return (unsigned int)m_Passes.size(); }
+	inline unsigned int GetExecutedPassCount() const { return (unsigned int)m_Order.size(); }
+	inline unsigned int GetTargetCount() const { return (unsigned int)m_Slots.size(); }
+private:
+	RenderGraphResource AddResource(const std::string& name, ResourceKind kind);
+	void Cull();
+	bool Sort();
+	void AssignSlots();
+	void PlaceBarriers();
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "RenderQueue.h"
+#include "Renderer.h"
+#include "scene/OcclusionCuller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+RenderQueue::RenderQueue(const AssetPack& pack)
+	: m_DepthShader(pack, "res/shaders/Depth.shader")
+{
+}
+
+void RenderQueue::Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const glm::mat4& model, RenderPass pass) {
+	Item item = { &va, nullptr, nullptr, nullptr, &ib, nullptr, { 0, 0 }, nullptr, 0, NO_OCCLUSION, &shader, model, 0.0f };
+	(pass == RenderPass::Opaque ? m_Opaque : m_Transparent).push_back(item);
+}
+
+void RenderQueue::Submit(VertexArrayCache& cache, const VertexBuffer& vb, const IndexBuffer& ib, const VertexBufferLayout& layout,
+	Shader& shader, const glm::mat4& model, RenderPass pass)
+{
+	Item item = { nullptr, &cache, &vb, &layout, &ib, nullptr, { 0, 0 }, nullptr, 0, NO_OCCLUSION, &shader, model, 0.0f };
+	(pass == RenderPass::Opaque ? m_Opaque : m_Transparent).push_back(item);
+}
+
+void RenderQueue::Submit(const MeshArena& arena, MeshHandle mesh, const MeshLodChain& lods, Shader& shader, const glm::mat4& model,
+	RenderPass pass, unsigned int occlusionIndex)
+{
+	Item item = { nullptr, nullptr, nullptr, nullptr, nullptr, &arena, mesh, &lods, 0, occlusionIndex, &shader, model, 0.0f };
+	(pass == RenderPass::Opaque ? m_Opaque : m_Transparent).push_back(item);
+}
+
+unsigned int RenderQueue::SelectLod(const Item& item, const glm::mat4& view, const glm::mat4& projection, float viewportHeight) const {
+	const MeshLodChain& lods = *item.lods;
+	const glm::mat4& model = item.model;
+	const float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	// Clip-space w of the bounding sphere's nearest point: its distance for a perspective
+	// projection, where projection[2][3] is -1, and always 1 for an orthographic one
+	const glm::vec4 center = projection * (view * (model * glm::vec4(lods.center, 1.0f)));
+	const float nearestW = center.w - std::fabs(projection[2][3]) * lods.radius * scale;
+	if (nearestW <= 0.0f) {
+		return 0; // Camera inside the bounds
+	}
+	const float pixelsPerUnit = scale * projection[1][1] * 0.5f * viewportHeight / nearestW;
+	return ::SelectLod(lods, pixelsPerUnit, m_MaxPixelError);
+}
+
+void RenderQueue::Draw(const Renderer& renderer, const Item& item, const Shader& shader) {
+	if (item.arena) {
+		renderer.Draw(*item.arena, item.mesh, item.lods->levels[item.lod], shader);
+	}
+	else if (item.cache) {
+		renderer.Draw(*item.cache, *item.vb, *item.ib, *item.layout, shader);
+	}
+	else {
+		renderer.Draw(*item.va, *item.ib, shader);
+	}
+}
+
+void RenderQueue::Execute(const Renderer& renderer, const glm::mat4& view, const glm::mat4& projection, float viewportHeight) {
+	const glm::mat4 viewProjection = projection * view;
+	std::fill(std::begin(m_LodDraws), std::end(m_LodDraws), 0);
+	for (std::vector<Item>* items : { &m_Opaque, &m_Transparent }) {
+		for (Item& item : *items) {
+			item.depth = -(view * item.model[3]).z; // The camera looks down -z
+			if (item.lods) {
+				item.lod = SelectLod(item, view, projection, viewportHeight); // Once, the pre-pass must draw the same level
+				m_LodDraws[item.lod]++;
+			}
+		}
+	}
+	std::stable_sort(m_Opaque.begin(), m_Opaque.end(), [](const Item& a, const Item& b) { return a.depth < b.depth; });
+	std::stable_sort(m_Transparent.begin(), m_Transparent.end(), [](const Item& a, const Item& b) { return a.depth > b.depth; });
+
+	GLCall(glEnable(GL_DEPTH_TEST));
+	GLCall(glDisable(GL_BLEND));
+	GLCall(glDepthMask(GL_TRUE));
+
+	if (m_DepthPrePass && !m_Opaque.empty()) {
+		// Depth only, the fragment shader is empty and color writes are off
+		GLCall(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+		GLCall(glDepthFunc(GL_LESS));
+		for (const Item& item : m_Opaque) {
+			m_DepthShader.Bind();
+			m_DepthShader.SetUniformMat4f("u_MVP", viewProjection * item.model);
+			Draw(renderer, item, m_DepthShader);
+		}
+		GLCall(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+
+		// Depth is final, shade only the fragments that won, each once
+		GLCall(glDepthMask(GL_FALSE));
+		GLCall(glDepthFunc(GL_LEQUAL));
+	}
+	else {
+		GLCall(glDepthFunc(GL_LESS));
+	}
+
+	for (const Item& item : m_Opaque) {
+		item.shader->Bind();
+		item.shader->SetUniformMat4f("u_MVP", viewProjection * item.model);
+		const bool occlusion = m_Occlusion && item.occlusionIndex != NO_OCCLUSION;
+		if (occlusion) {
+			m_Occlusion->BeginDraw(item.occlusionIndex); // May test the bounds first, under another program
+		}
+		Draw(renderer, item, *item.shader);
+		if (occlusion) {
+			m_Occlusion->EndDraw(item.occlusionIndex);
+		}
+	}
+
+	if (!m_Transparent.empty()) {
+		// Test against the opaque depth, but never hide other transparent surfaces
+		GLCall(glEnable(GL_BLEND));
+		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+		GLCall(glDepthMask(GL_FALSE));
+		GLCall(glDepthFunc(GL_LEQUAL));
+		for (const Item& item : m_Transparent) {
+			item.shader->Bind();
+			item.shader->SetUniformMat4f("u_MVP", viewProjection * item.model);
+			Draw(renderer, item, *item.shader);
+		}
+		GLCall(glDisable(GL_BLEND));
+	}
+
+	GLCall(glDepthMask(GL_TRUE)); // glClear only clears depth while writes are on
+	GLCall(glDepthFunc(GL_LESS));
+	m_Opaque.clear();
+	m_Transparent.clear();
+}
\ No newline at end of file
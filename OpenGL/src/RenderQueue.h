@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "Shader.h"
+#include "buffers/MeshArena.h"
+#include "mesh/MeshLod.h"
+
+class Renderer;
+class VertexArray;
+class VertexArrayCache;
+class VertexBuffer;
+class VertexBufferLayout;
+class IndexBuffer;
+class OcclusionCuller;
+
+enum class RenderPass {
+	Opaque, // Depth test and write, no blending, drawn front to back
+	Transparent // Blended over the opaque result, depth test without write, drawn back to front
+};
+
+// Collects a frame's draws and runs them as passes with the GL state each one needs, instead
+// of one global state for everything. Opaque draws go front to back so early-Z rejects hidden
+// fragments; with the depth pre-pass on, a position-only pass (res/shaders/Depth.shader) lays
+// down depth first and the opaque pass shades every pixel once. Every shader gets its item's
+// u_MVP, and opaque shaders must declare "invariant gl_Position" like Depth.shader does, or the
+// two programs may compute slightly different depths and the pre-pass hides what it should keep.
+// Meshes submitted with a MeshLodChain get the coarsest level whose error stays under a pixel
+// budget for that instance's size on screen, chosen once per Execute for every pass. With an
+// OcclusionCuller set, opaque items submitted with its object index are drawn between its
+// BeginDraw and EndDraw; the front-to-back order makes the items before them the occluders.
+// The depth pre-pass leaves little for the queries to hide, the objects' own depth is already in.
+// Leaves depth writes on and blending off, so Renderer::Clear still clears depth.
+class RenderQueue {
+private:
+	struct Item {
+		const VertexArray* va; // Or the VAO comes from cache, for vb with layout
+		VertexArrayCache* cache;
+		const VertexBuffer* vb;
+		const VertexBufferLayout* layout;
+		const IndexBuffer* ib;
+		const MeshArena* arena; // Or mesh out of arena, with one of its lods
+		MeshHandle mesh;
+		const MeshLodChain* lods;
+		unsigned int lod; // Picked by Execute
+		unsigned int occlusionIndex; // In m_Occlusion, NO_OCCLUSION when not tested
+		Shader* shader;
+		glm::mat4 model;
+		float depth; // View-space distance of the model origin, the sort key
+	};
+
+	std::vector<Item> m_Opaque;
+	std::vector<Item> m_Transparent;
+	Shader m_DepthShader;
+	bool m_DepthPrePass = false;
+	float m_MaxPixelError = 1.0f;
+	OcclusionCuller* m_Occlusion = nullptr;
+	unsigned int m_LodDraws[MESH_MAX_LODS] = {}; // Per level, of the last Execute
+public:
+	static const unsigned int NO_OCCLUSION = 0xFFFFFFFF;
+
+	RenderQueue(const AssetPack& pack); // Loads res/shaders/Depth.shader
+
+	// va, ib and shader must live until Execute
+	void Submit(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const glm::mat4& model, RenderPass pass = RenderPass::Opaque);
+	// Same, with the VAO taken from cache when the item is drawn
+	void Submit(VertexArrayCache& cache, const VertexBuffer& vb, const IndexBuffer& ib, const VertexBufferLayout& layout,
+		Shader& shader, const glm::mat4& model, RenderPass pass = RenderPass::Opaque);
+	// A mesh stored in arena as a MeshLodChain, see MeshLod.h, drawn at the level its screen size needs.
+	// occlusionIndex is the object's index in the OcclusionCuller, used for opaque items while one is set.
+	void Submit(const MeshArena& arena, MeshHandle mesh, const MeshLodChain& lods, Shader& shader, const glm::mat4& model,
+		RenderPass pass = RenderPass::Opaque, unsigned int occlusionIndex = NO_OCCLUSION);
+
+	// Sorts and draws everything submitted since the last Execute, then empties the queue.
+	// viewportHeight in pixels turns LOD errors into screen-space errors.
+	void Execute(const Renderer& renderer, const glm::mat4& view, const glm::mat4& projection, float viewportHeight);
+
+	// Worth it when opaque fragments are expensive and overlap a lot, the geometry is drawn twice
+	inline void SetDepthPrePass(bool enabled) { m_DepthPrePass = enabled; }
+	inline bool HasDepthPrePass() const { return m_DepthPrePass; }
+	// The culler's BeginFrame must run before Execute, nullptr turns occlusion culling off
+	inline void SetOcclusionCuller(OcclusionCuller* culler) { m_Occlusion = culler; }
+	inline OcclusionCuller* GetOcclusionCuller() const { return m_Occlusion; }
+	inline void SetMaxPixelError(float pixels) { m_MaxPixelError = pixels; }
+	inline float GetMaxPixelError() const { return m_MaxPixelError; }
+	inline unsigned int GetLodDraws(unsigned int level) const { return m_LodDraws[level]; }
+private:
+	unsigned int SelectLod(const Item& item, const glm::mat4& view, const glm::mat4& projection, float viewportHeight) const;
+	static void Draw(const Renderer& renderer, const Item& item, const Shader& shader);
+};
\ No newline at end of file
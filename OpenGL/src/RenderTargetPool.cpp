@@ -0,0 +1,53 @@
+#include "RenderTargetPool.h"
+
+RenderTargetPool::RenderTargetPool(unsigned int maxIdleFrames)
+	: m_Frame(0), m_MaxIdleFrames(maxIdleFrames), m_Created(0)
+{
+}
+
+Framebuffer& RenderTargetPool::Acquire(const FramebufferSpec& spec) {
+	for (Entry& entry : m_Entries) {
+		if (!entry.inUse && entry.target->GetSpec() == spec) {
+			entry.inUse = true;
+			entry.lastUsedFrame = m_Frame;
+			return *entry.target;
+		}
+	}
+
+	m_Entries.push_back({ std::unique_ptr<Framebuffer>(new Framebuffer(spec)), m_Frame, true });
+	m_Created++;
+	return *m_Entries.back().target;
+}
+
+void RenderTargetPool::Release(const Framebuffer& target, bool discard) {
+	for (Entry& entry : m_Entries) {
+		if (entry.target.get() == &target) {
+			ASSERT(entry.inUse);
+			if (discard) {
+				target.Discard();
+			}
+			entry.inUse = false;
+			return;
+		}
+	}
+	ASSERT(false); // Not from this pool
+}
+
+void RenderTargetPool::EndFrame() {
+	for (unsigned int i = 0; i < m_Entries.size();) {
+		Entry& entry = m_Entries[i];
+		entry.inUse = false; // A target kept past the frame would alias the next Acquire
+		if (m_Frame - entry.lastUsedFrame >= m_MaxIdleFrames) {
+			m_Entries[i] = std::move(m_Entries.back());
+			m_Entries.pop_back();
+		}
+		else {
+			i++;
+		}
+	}
+	m_Frame++;
+}
+
+void RenderTargetPool::Clear() {
+	m_Entries.clear();
+}
\ No newline at end of file
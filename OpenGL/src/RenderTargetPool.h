@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Framebuffer.h"
+
+// Lends out transient render targets for the passes of a frame, so effects share a few
+// framebuffers instead of each allocating its own. Acquire hands back a free target with the
+// same spec when there is one and creates it otherwise; Release returns it to the next pass that
+// wants that spec and discards its contents, which are dead by then. EndFrame frees targets no
+// pass asked for in maxIdleFrames frames, e.g. the old size after a window resize.
+class RenderTargetPool {
+private:
+	struct Entry {
+		std::unique_ptr<Framebuffer> target; // Stays put while the vector grows
+		unsigned int lastUsedFrame;
+		bool inUse;
+	};
+
+	std::vector<Entry> m_Entries;
+	unsigned int m_Frame;
+	unsigned int m_MaxIdleFrames;
+	unsigned int m_Created; // Targets created over the pool's lifetime
+public:
+	RenderTargetPool(unsigned int maxIdleFrames = 3);
+
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+	// Valid until Release, the caller must not keep it past the frame
+	Framebuffer& Acquire(const FramebufferSpec& spec);
+	void Release(const Framebuffer& target, bool discard = true); // Pass false when the next user reads the contents
+	void EndFrame(); // Every target should be released by now
+	void Clear();
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Entries.size(); }
+	inline unsigned int GetCreatedCount() const { return m_Created; }
+};
\ No newline at end of file
@@ -1,4 +1,8 @@
 #include "Renderer.h"
+#include "buffers/MeshArena.h"
+#include "buffers/VertexArrayCache.h"
+#include "mesh/MeshLod.h"
+#include "scene/GpuCuller.h"
 #include <iostream>
 
 void GLClearError() {
@@ -14,12 +18,92 @@ bool GLLogCall(const char* function, const char* file, int line) {
     return true; // Return true if no errors occurred
 }
 
+bool GLHasDirectStateAccess() {
+    static const bool supported = GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access; // Queried once, after glewInit
+    return supported;
+}
+
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const {
     shader.Bind(); // Bind the shader program
     va.Bind(); // Bind the Vertex Array Object (VAO)
     ib.Bind(); // Bind the Index Buffer Object (IBO)
 
-    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const {
+    shader.Bind(); // Bind the shader program
+    va.Bind(); // Bind the VAO, its instance attributes advance per instance
+    ib.Bind(); // Bind the Index Buffer Object (IBO)
+
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr, instanceCount));
+}
+
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount, unsigned int baseInstance) const {
+    shader.Bind(); // Bind the shader program
+    va.Bind(); // Bind the VAO, its instance attributes advance per instance
+    ib.Bind(); // Bind the Index Buffer Object (IBO)
+
+    // The base instance offsets instanced attributes only, per-vertex data starts where it always does
+    GLCall(glDrawElementsInstancedBaseInstance(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr, instanceCount, baseInstance));
+}
+
+void Renderer::Draw(VertexArrayCache& cache, const VertexBuffer& vb, const IndexBuffer& ib, const VertexBufferLayout& layout, const Shader& shader) const {
+    shader.Bind(); // Bind the shader program
+    cache.Bind(vb, ib, layout); // Bind a cached VAO with vb and ib attached
+
+    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), ib.GetType(), nullptr));
+}
+
+void Renderer::Draw(const MeshArena& arena, MeshHandle mesh, const Shader& shader) const {
+    Draw(arena, &mesh, 1, shader);
+}
+
+void Renderer::Draw(const MeshArena& arena, const MeshHandle* meshes, unsigned int count, const Shader& shader) const {
+    shader.Bind(); // Bind the shader program
+    arena.GetVertexArray().Bind(); // The arena's VAO already references its shared index buffer
+    const unsigned int indexType = arena.GetIndexBuffer().GetType();
+    const unsigned int indexSize = IndexBuffer::GetSizeOfType(indexType);
+
+    for (unsigned int i = 0; i < count; i++) {
+        const MeshRange& range = arena.GetRange(meshes[i]);
+        GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, indexType,
+            (void*)((size_t)range.firstIndex * indexSize), range.baseVertex));
+    }
+}
+void Renderer::Draw(const MeshArena& arena, MeshHandle mesh, const MeshLodLevel& level, const Shader& shader) const {
+    shader.Bind(); // Bind the shader program
+    arena.GetVertexArray().Bind();
+    const unsigned int indexType = arena.GetIndexBuffer().GetType();
+    const MeshRange& range = arena.GetRange(mesh);
+    ASSERT(level.firstIndex + level.indexCount <= range.indexCount);
+
+    // The level's indices sit inside the mesh's index range and share its base vertex
+    GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, level.indexCount, indexType,
+        (void*)((size_t)(range.firstIndex + level.firstIndex) * IndexBuffer::GetSizeOfType(indexType)), range.baseVertex));
+}
+
+void Renderer::DrawIndirect(const GpuCuller& culler, const Shader& shader) const {
+    shader.Bind(); // Bind the shader program
+    culler.GetArena().GetVertexArray().Bind(); // The arena's VAO also carries the object index attribute
+    GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, GpuCuller::TRANSFORM_BINDING, culler.GetTransformBuffer().GetRendererID()));
+    GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, culler.GetCommandBuffer().GetRendererID()));
+    const unsigned int indexType = culler.GetArena().GetIndexBuffer().GetType();
+
+    if (culler.HasDrawCount()) {
+        // Only the draws the culling pass appended, their count never comes back to the CPU
+        GLCall(glBindBuffer(GL_PARAMETER_BUFFER_ARB, culler.GetCountBuffer().GetRendererID()));
+        GLCall(glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, indexType, nullptr, 0, culler.GetCount(), 0));
+    }
+    else {
+        GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, nullptr, culler.GetCount(), 0)); // Hidden objects have 0 instances
+    }
+}
+
+void Renderer::DrawFullscreen(const VertexArray& va, const Shader& shader) const {
+    shader.Bind(); // Bind the shader program
+    va.Bind(); // Core profile draws need a VAO even when no attribute is read
+    GLCall(glDrawArrays(GL_TRIANGLES, 0, 3)); // One triangle covering the screen, positions come from gl_VertexID
 }
 
 void Renderer::Clear() const {
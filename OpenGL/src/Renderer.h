@@ -6,6 +6,13 @@
 #include "buffers/IndexBuffer.h"
 #include "Shader.h"
 
+class MeshArena;
+class GpuCuller;
+struct MeshHandle;
+struct MeshLodLevel;
+class VertexArrayCache;
+class VertexBufferLayout;
+
 // Macro to assert conditions, triggering a breakpoint if false
 #define ASSERT(x) if (!(x)) __debugbreak() 
 // Macro to clear OpenGL errors before and after a function call
@@ -15,8 +22,20 @@ void GLClearError();
 
 bool GLLogCall(const char* function, const char* file, int line);
 
+// Whether the context has Direct State Access (GL 4.5 / ARB_direct_state_access).
+// Resource classes edit GL objects by name when it does, and bind-to-edit otherwise (GL 3.3)
+bool GLHasDirectStateAccess();
+
 class Renderer {
 public:
 	void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+	void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const; // va needs an instance buffer, see VertexArray::AddInstanceBuffer
+	void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount, unsigned int baseInstance) const; // GL 4.2, instances start baseInstance entries into the buffer
+	void Draw(VertexArrayCache& cache, const VertexBuffer& vb, const IndexBuffer& ib, const VertexBufferLayout& layout, const Shader& shader) const; // VAO comes from the cache
+	void Draw(const MeshArena& arena, MeshHandle mesh, const Shader& shader) const; // One mesh out of a shared arena
+	void Draw(const MeshArena& arena, const MeshHandle* meshes, unsigned int count, const Shader& shader) const; // Binds the arena once for all meshes
+	void Draw(const MeshArena& arena, MeshHandle mesh, const MeshLodLevel& level, const Shader& shader) const; // One level of a MeshLodChain stored as that mesh
+	void DrawIndirect(const GpuCuller& culler, const Shader& shader) const; // Every object the culler's last pass kept, one call
+	void DrawFullscreen(const VertexArray& va, const Shader& shader) const; // va can be empty, see PostProcessChain
 	void Clear() const;
 };
\ No newline at end of file
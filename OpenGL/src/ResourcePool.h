@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Reference to a resource in a ResourcePool. The generation changes every time a slot is
+// reused, so a handle to a released resource never resolves to whatever replaced it.
+template<typename T>
+struct Handle {
+	uint32_t index = 0xFFFFFFFF;
+	uint32_t generation = 0;
+
+	inline bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+	inline bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// Owns move-only GPU resources (VertexBuffer, Texture, Shader...) in a dense array.
+// Handles map to the dense array through a slot table, so lookup is O(1), iteration touches
+// only live resources, and Release swaps the last resource into the hole.
+template<typename T>
+class ResourcePool {
+private:
+	struct Slot {
+		uint32_t denseIndex; // Position in m_Resources while alive
+		uint32_t generation;
+		bool alive;
+	};
+
+	std::vector<T> m_Resources; // Dense, live resources only
+	std::vector<uint32_t> m_DenseToSlot; // Slot that owns each dense entry
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeSlots;
+public:
+	ResourcePool() = default;
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	// Constructs the resource in place, e.g. pool.Create("res/shaders/Basic.shader")
+	template<typename... Args>
+	Handle<T> Create(Args&&... args) {
+		uint32_t slotIndex;
+		if (!m_FreeSlots.empty()) {
+			slotIndex = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else {
+			slotIndex = (uint32_t)m_Slots.size();
+			m_Slots.push_back({ 0, 0, false });
+		}
+
+		m_Resources.emplace_back(std::forward<Args>(args)...);
+		m_DenseToSlot.push_back(slotIndex);
+
+		Slot& slot = m_Slots[slotIndex];
+		slot.denseIndex = (uint32_t)m_Resources.size() - 1;
+		slot.alive = true;
+		return { slotIndex, slot.generation };
+	}
+
+	// Destroys the resource now, its handle and any copies of it become invalid
+	void Release(Handle<T> handle) {
+		if (!IsValid(handle)) {
+			return;
+		}
+		Slot& slot = m_Slots[handle.index];
+		uint32_t last = (uint32_t)m_Resources.size() - 1;
+		if (slot.denseIndex != last) {
+			// Fill the hole with the last resource and repoint its slot
+			m_Resources[slot.denseIndex] = std::move(m_Resources[last]);
+			m_DenseToSlot[slot.denseIndex] = m_DenseToSlot[last];
+			m_Slots[m_DenseToSlot[last]].denseIndex = slot.denseIndex;
+		}
+		m_Resources.pop_back(); // Destroys the moved-from resource, which owns nothing now
+		m_DenseToSlot.pop_back();
+
+		slot.alive = false;
+		slot.generation++;
+		m_FreeSlots.push_back(handle.index);
+	}
+
+	// Destroys every resource in one go, all outstanding handles become invalid
+	void Clear() {
+		for (uint32_t i = 0; i < m_Slots.size(); i++) {
+			if (m_Slots[i].alive) {
+				m_Slots[i].alive = false;
+				m_Slots[i].generation++;
+				m_FreeSlots.push_back(i);
+			}
+		}
+		m_Resources.clear();
+		m_DenseToSlot.clear();
+	}
+
+	inline bool IsValid(Handle<T> handle) const {
+		return handle.index < m_Slots.size() && m_Slots[handle.index].alive && m_Slots[handle.index].generation == handle.generation;
+	}
+
+	// Returns nullptr for stale or invalid handles
+	inline T* Get(Handle<T> handle) { return IsValid(handle) ? &m_Resources[m_Slots[handle.index].denseIndex] : nullptr; }
+	inline const T* Get(Handle<T> handle) const { return IsValid(handle) ? &m_Resources[m_Slots[handle.index].denseIndex] : nullptr; }
+
+	inline unsigned int GetSize() const { return (unsigned int)m_Resources.size(); }
+	inline typename std::vector<T>::iterator begin() { return m_Resources.begin(); }
+	inline typename std::vector<T>::iterator end() { return m_Resources.end(); }
+};
\ No newline at end of file
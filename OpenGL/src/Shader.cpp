@@ -3,6 +3,8 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <cstring>
+#include <string_view>
 
 #include "Renderer.h"
 #include "Shader.h"
@@ -11,44 +13,102 @@ Shader::Shader(const std::string& filepath)
 	: m_FilePath(filepath), m_RendererID(0)
 {
 	ShaderProgramSource source = ParseShader(filepath); // Parse the shader fill
-	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource); // Create the shader program
+	m_RendererID = CreateProgram(source); // Create the shader program
 }
 
 Shader::~Shader() {
 	GLCall(glDeleteProgram(m_RendererID)); // Delete the shader program
 }
 
+Shader::Shader(Shader&& other) noexcept
+	: m_FilePath(std::move(other.m_FilePath)), m_RendererID(other.m_RendererID),
+	m_UniformLocationCache(std::move(other.m_UniformLocationCache))
+{
+	other.m_RendererID = 0; // glDeleteProgram(0) is a no-op
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept {
+	if (this != &other) {
+		GLCall(glDeleteProgram(m_RendererID)); // Release the program we are replacing
+		m_FilePath = std::move(other.m_FilePath);
+		m_RendererID = other.m_RendererID;
+		m_UniformLocationCache = std::move(other.m_UniformLocationCache);
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
+Shader::Shader(const AssetPack& pack, const std::string& filepath)
+	: m_FilePath(filepath), m_RendererID(0)
+{
+	AssetView asset = pack.Find(filepath);
+	ShaderProgramSource source = asset.IsValid()
+		? ParseShader(reinterpret_cast<const char*>(asset.data), asset.size) // Parse in place from the mapping
+		: ParseShader(filepath); // Not packed, read the loose file
+	m_RendererID = CreateProgram(source); // Create the shader program
+}
+
+Shader::Shader()
+	: m_RendererID(0)
+{
+}
+
+Shader Shader::FromSource(const std::string& name, const std::string& source) {
+	Shader shader;
+	shader.m_FilePath = name;
+	shader.m_RendererID = shader.CreateProgram(shader.ParseShader(source.data(), source.size()));
+	return shader;
+}
+
 ShaderProgramSource Shader::ParseShader(const std::string& filepath) {
-	std::ifstream stream(filepath); // Open the shader file
+	std::ifstream stream(filepath, std::ios::binary); // Open the shader file
+	std::stringstream ss;
+	ss << stream.rdbuf(); // Read the whole file at once
+	const std::string contents = ss.str();
+
+	return ParseShader(contents.data(), contents.size());
+}
 
+ShaderProgramSource Shader::ParseShader(const char* source, size_t size) {
 	enum class ShaderType {
-		NONE = -1, VERTEX = 0, FRAGMENT = 1
+		NONE = -1, VERTEX = 0, FRAGMENT = 1, COMPUTE = 2
 	};
 
-	std::string line; // String to hold each line of the shader file
-	std::stringstream ss[2];
+	std::string sources[3];
 	ShaderType type = ShaderType::NONE; // Initialize the shader type to NONE
 
-	// Read each line of the shader file
-	while (getline(stream, line)) {
-		if (line.find("#shader") != std::string::npos) { // Check if the line contains a shader directive
+	// Walk each line of the shader source in place, only the stage sources are copied
+	const char* end = source + size;
+	for (const char* line = source; line < end;) {
+		const char* lineEnd = static_cast<const char*>(memchr(line, '\n', end - line));
+		if (!lineEnd) {
+			lineEnd = end; // Last line without a trailing newline
+		}
+		const std::string_view text(line, lineEnd - line);
+		const char* next = lineEnd < end ? lineEnd + 1 : end; // Past the newline
+
+		if (text.find("#shader") != std::string_view::npos) { // Check if the line contains a shader directive
 			// Check if the shader is a vertex shader
-			if (line.find("vertex") != std::string::npos) {
+			if (text.find("vertex") != std::string_view::npos) {
 				type = ShaderType::VERTEX; // Set the shader type to VERTEX
 			}
 			// Check if the shader is a fragment shader
-			else if (line.find("fragment") != std::string::npos) {
+			else if (text.find("fragment") != std::string_view::npos) {
 				type = ShaderType::FRAGMENT; // Set the shader type to FRAGMENT
 			}
+			else if (text.find("compute") != std::string_view::npos) {
+				type = ShaderType::COMPUTE;
+			}
 		}
-		else {
+		else if (type != ShaderType::NONE) {
 			// If the line does not contain a shader directive
-			// Append the line to the appropriate shader type's stringstream
-			ss[(int)type] << line << '\n';
+			// Append the line and its newline to the appropriate shader type's source
+			sources[(int)type].append(line, next - line);
 		}
+		line = next;
 	}
 
-	return { ss[0].str(), ss[1].str() }; // Return the vertex and fragment shader sources as a ShaderProgramSource struct
+	return { sources[0], sources[1], sources[2] }; // Return the shader sources as a ShaderProgramSource struct
 }
 unsigned int Shader::CompileShader(const std::string& source, unsigned int type) {
 	unsigned int id = glCreateShader(type); // Create a shader object of the specified type
@@ -64,7 +124,7 @@ unsigned int Shader::CompileShader(const std::string& source, unsigned int type)
 		char* message = (char*)_malloca(length * sizeof(char)); // Create a buffer for the error message
         glGetShaderInfoLog(id, length, &length, message); // Get the error message
         std::cerr << "Failed to compile" 
-            << (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
+            << (type == GL_VERTEX_SHADER ? "vertex" : type == GL_COMPUTE_SHADER ? "compute" : "fragment")
             << "shader!" << std::endl; // Print an error message
         std::cerr << message << std::endl; // Print the error message
         glDeleteShader(id); // Delete the shader object
@@ -90,6 +150,26 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
 	return program; // Return the shader program ID
 }
 
+unsigned int Shader::CreateComputeShader(const std::string& computeShader) {
+	unsigned int program = glCreateProgram();
+	unsigned int cs = CompileShader(computeShader, GL_COMPUTE_SHADER); // Needs GL 4.3
+
+	glAttachShader(program, cs);
+	glLinkProgram(program);
+	glValidateProgram(program);
+
+	glDeleteShader(cs);
+
+	return program;
+}
+
+unsigned int Shader::CreateProgram(const ShaderProgramSource& source) {
+	if (!source.ComputeSource.empty()) {
+		return CreateComputeShader(source.ComputeSource);
+	}
+	return CreateShader(source.VertexSource, source.FragmentSource);
+}
+
 void Shader::Bind() const {
 	GLCall(glUseProgram(m_RendererID)); // Bind the shader program for use
 }
@@ -102,10 +182,22 @@ void Shader::SetUniform1i(const std::string& name, int value) {
 	GLCall(glUniform1i(GetUniformLocation(name), value)); // Set an integer uniform variable in the shader
 }
 
+void Shader::SetUniform1f(const std::string& name, float value) {
+	GLCall(glUniform1f(GetUniformLocation(name), value)); // Set a float uniform variable in the shader
+}
+
+void Shader::SetUniform2f(const std::string& name, float v0, float v1) {
+	GLCall(glUniform2f(GetUniformLocation(name), v0, v1)); // Set a 2D float uniform variable in the shader
+}
+
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3) {
 	GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3)); // Set a 4D float uniform variable in the shader
 }
 
+void Shader::SetUniform4fv(const std::string& name, unsigned int count, const float* values) {
+	GLCall(glUniform4fv(GetUniformLocation(name), count, values)); // Set every element of a vec4 array at once
+}
+
 void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix) {
 	GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0])); // Set a 4x4 matrix uniform variable in the shader
 }
@@ -5,9 +5,12 @@
 
 #include <glm/glm.hpp> // Include GLM for matrix types
 
+#include "assets/AssetPack.h"
+
 struct ShaderProgramSource {
 	std::string VertexSource; // Source code for the vertex shader
 	std::string FragmentSource; // Source code for the fragment shader
+	std::string ComputeSource; // Source code for a compute shader, a program is either compute or vertex + fragment
 };
 
 class Shader {
@@ -17,18 +20,33 @@ private:
 	std::unordered_map<std::string, int> m_UniformLocationCache; // Cache for uniform locations
 public:
 	Shader(const std::string& filepath);
+	Shader(const AssetPack& pack, const std::string& filepath); // Parses straight from the pack mapping, falls back to the loose file
+	static Shader FromSource(const std::string& name, const std::string& source); // Same "#shader" format as the files, e.g. generated code
 	~Shader();
 
+	// The program is owned, so the shader can move but never be copied
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
 
 	// Set uniform functions
 	void SetUniform1i(const std::string& name, int value);
+	void SetUniform1f(const std::string& name, float value);
+	void SetUniform2f(const std::string& name, float v0, float v1);
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
+	void SetUniform4fv(const std::string& name, unsigned int count, const float* values); // A vec4 array, 4 floats per element
 	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
 private:
+	Shader(); // Empty, FromSource fills it in
 	ShaderProgramSource ParseShader(const std::string& filepath);
+	ShaderProgramSource ParseShader(const char* source, size_t size);
 	unsigned int CompileShader(const std::string& source, unsigned int type);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+	unsigned int CreateComputeShader(const std::string& computeShader);
+	unsigned int CreateProgram(const ShaderProgramSource& source); // Compute or vertex + fragment, whichever the source has
 	int GetUniformLocation(const std::string& name);
 };
\ No newline at end of file
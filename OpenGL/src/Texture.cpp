@@ -7,6 +7,53 @@ Texture::Texture(const std::string& path)
 	stbi_set_flip_vertically_on_load(1); // Flip the image vertically to match OpenGL's texture coordinate system
 	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4); // Load the image with 4 channels (RGBA)
 
+	Upload();
+}
+
+Texture::Texture(const AssetPack& pack, const std::string& path)
+	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+{
+	stbi_set_flip_vertically_on_load(1); // Flip the image vertically to match OpenGL's texture coordinate system
+
+	AssetView asset = pack.Find(path);
+	if (asset.IsValid()) {
+		// Decode the compressed bytes in place from the mapping, the decoded image is the only copy before the upload
+		m_LocalBuffer = stbi_load_from_memory(asset.data, (int)asset.size, &m_Width, &m_Height, &m_BPP, 4);
+	}
+	else {
+		m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4); // Not packed, load the loose file
+	}
+
+	Upload();
+}
+
+void Texture::Upload() {
+	if (GLHasDirectStateAccess()) {
+		GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID)); // Create the texture without disturbing the bound one
+
+		GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+		GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		// Set texture wrapping parameters
+		GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+		if (m_Width > 0 && m_Height > 0) {
+			// Immutable storage, the driver knows the final size and format up front
+			GLCall(glTextureStorage2D(m_RendererID, 1, GL_RGBA8, m_Width, m_Height));
+			GLCall(glTextureSubImage2D(m_RendererID, 0, 0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
+		}
+	}
+	else {
+		UploadBound();
+	}
+
+	if (m_LocalBuffer) {
+		stbi_image_free(m_LocalBuffer);
+		m_LocalBuffer = nullptr;
+	}
+}
+
+void Texture::UploadBound() {
 	GLCall(glGenTextures(1, &m_RendererID));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
 
@@ -19,17 +66,37 @@ Texture::Texture(const std::string& path)
 
 	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
 	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
-
-	if (m_LocalBuffer) {
-		stbi_image_free(m_LocalBuffer);
-	}
 }
 
 Texture::~Texture() {
 	GLCall(glDeleteTextures(1, &m_RendererID)); // Delete the texture from OpenGL
 }
 
+Texture::Texture(Texture&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_FilePath(std::move(other.m_FilePath)), m_LocalBuffer(nullptr),
+	m_Width(other.m_Width), m_Height(other.m_Height), m_BPP(other.m_BPP)
+{
+	other.m_RendererID = 0; // The moved-from texture deletes nothing
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept {
+	if (this != &other) {
+		GLCall(glDeleteTextures(1, &m_RendererID)); // Release the texture we are replacing
+		m_RendererID = other.m_RendererID;
+		m_FilePath = std::move(other.m_FilePath);
+		m_Width = other.m_Width;
+		m_Height = other.m_Height;
+		m_BPP = other.m_BPP;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
 void Texture::Bind(unsigned int slot) const {
+	if (GLHasDirectStateAccess()) {
+		GLCall(glBindTextureUnit(slot, m_RendererID)); // Bind to the unit directly, the active texture unit is left alone
+		return;
+	}
 	GLCall(glActiveTexture(GL_TEXTURE0 + slot)); // Activate the texture unit
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID)); // Bind the texture to the specified slot
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Renderer.h"
+#include "assets/AssetPack.h"
 
 class Texture
 {
@@ -11,11 +12,21 @@ private:
 	int m_Width, m_Height, m_BPP; // BPP: Bytes Per Pixel
 public:
 	Texture(const std::string& path);
+	Texture(const AssetPack& pack, const std::string& path); // Decodes straight from the pack mapping, falls back to the loose file
 	~Texture();
 
+	// The GL texture is owned, so it can move but never be copied
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+
 	void Bind(unsigned int slot = 0) const;
 	void Unbind() const;
 
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+private:
+	void Upload(); // Creates the GL texture from m_LocalBuffer and releases it
+	void UploadBound(); // Bind-to-edit path for contexts without Direct State Access
 };
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+AssetPack::AssetPack(const std::string& filepath)
+	: m_FilePath(filepath), m_Header(nullptr), m_Entries(nullptr)
+{
+	if (!m_File.Open(m_FilePath)) {
+		return; // A missing pack is not an error, callers fall back to loose files
+	}
+
+	if (!Validate()) {
+		std::cerr << "Asset pack '" << m_FilePath << "' is corrupt or from a different version" << std::endl;
+		m_File.Close();
+		return;
+	}
+
+	m_Header = reinterpret_cast<const AssetPackHeader*>(m_File.GetData());
+	m_Entries = reinterpret_cast<const AssetPackEntry*>(m_File.GetData() + sizeof(AssetPackHeader));
+}
+
+AssetView AssetPack::Find(const std::string& name) const {
+	if (!IsOpen()) {
+		return { nullptr, 0 };
+	}
+
+	uint64_t hash = HashName(name);
+	unsigned int bucket = (unsigned int)(hash >> 56); // Top byte selects the fanout bucket
+
+	// The fanout table narrows the search to the entries sharing the top byte, which is a handful at most
+	const AssetPackEntry* first = m_Entries + (bucket == 0 ? 0 : m_Header->fanout[bucket - 1]);
+	const AssetPackEntry* last = m_Entries + m_Header->fanout[bucket];
+	const AssetPackEntry* it = std::lower_bound(first, last, hash,
+		[](const AssetPackEntry& entry, uint64_t value) { return entry.hash < value; });
+
+	if (it == last || it->hash != hash) {
+		return { nullptr, 0 };
+	}
+	return { m_File.GetData() + it->offset, (size_t)it->size };
+}
+
+uint64_t AssetPack::HashName(const std::string& name) {
+	uint64_t hash = 14695981039346656037ull; // FNV-1a offset basis
+	for (char c : name) {
+		hash ^= (unsigned char)(c == '\\' ? '/' : c); // Treat both path separators the same
+		hash *= 1099511628211ull; // FNV-1a prime
+	}
+	return hash;
+}
+
+bool AssetPack::Build(const std::string& outputPath, const std::vector<std::string>& files) {
+	std::vector<AssetPackEntry> entries;
+	std::vector<std::vector<char>> payloads;
+	entries.reserve(files.size());
+	payloads.reserve(files.size());
+
+	for (const std::string& file : files) {
+		std::ifstream stream(file, std::ios::binary);
+		if (!stream) {
+			std::cerr << "Failed to open '" << file << "' for packing" << std::endl;
+			return false;
+		}
+		payloads.emplace_back(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		entries.push_back({ HashName(file), (uint64_t)payloads.size() - 1, (uint64_t)payloads.back().size() });
+	}
+
+	// Sort by hash, the offset field temporarily holds the payload index
+	std::sort(entries.begin(), entries.end(),
+		[](const AssetPackEntry& a, const AssetPackEntry& b) { return a.hash < b.hash; });
+	for (size_t i = 1; i < entries.size(); i++) {
+		if (entries[i].hash == entries[i - 1].hash) {
+			std::cerr << "Asset pack hash collision between '" << files[entries[i].offset]
+				<< "' and '" << files[entries[i - 1].offset] << "'" << std::endl;
+			return false;
+		}
+	}
+
+	AssetPackHeader header = {};
+	header.magic = ASSET_PACK_MAGIC;
+	header.version = ASSET_PACK_VERSION;
+	header.entryCount = (uint32_t)entries.size();
+	for (const AssetPackEntry& entry : entries) {
+		header.fanout[entry.hash >> 56]++;
+	}
+	for (unsigned int b = 1; b < 256; b++) {
+		header.fanout[b] += header.fanout[b - 1]; // Turn the histogram into running totals
+	}
+
+	// Lay out the payloads after the index, each one on its own aligned boundary
+	std::vector<size_t> order(entries.size());
+	uint64_t offset = sizeof(AssetPackHeader) + entries.size() * sizeof(AssetPackEntry);
+	for (size_t i = 0; i < entries.size(); i++) {
+		offset = (offset + ASSET_PACK_ALIGNMENT - 1) & ~(ASSET_PACK_ALIGNMENT - 1);
+		order[i] = (size_t)entries[i].offset;
+		entries[i].offset = offset;
+		offset += entries[i].size;
+	}
+
+	std::ofstream stream(outputPath, std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		std::cerr << "Failed to create asset pack '" << outputPath << "'" << std::endl;
+		return false;
+	}
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(AssetPackEntry));
+
+	const char padding[ASSET_PACK_ALIGNMENT] = {};
+	for (size_t i = 0; i < entries.size(); i++) {
+		uint64_t position = (uint64_t)stream.tellp();
+		stream.write(padding, (std::streamsize)(entries[i].offset - position));
+		const std::vector<char>& payload = payloads[order[i]];
+		stream.write(payload.data(), (std::streamsize)payload.size());
+	}
+
+	return (bool)stream;
+}
+
+bool AssetPack::Validate() const {
+	const unsigned char* data = m_File.GetData();
+	const size_t size = m_File.GetSize();
+	if (size < sizeof(AssetPackHeader)) {
+		return false;
+	}
+	const AssetPackHeader* header = reinterpret_cast<const AssetPackHeader*>(data);
+	if (header->magic != ASSET_PACK_MAGIC || header->version != ASSET_PACK_VERSION) {
+		return false;
+	}
+	if (header->fanout[255] != header->entryCount
+		|| sizeof(AssetPackHeader) + (uint64_t)header->entryCount * sizeof(AssetPackEntry) > size) {
+		return false;
+	}
+	for (unsigned int b = 1; b < 256; b++) {
+		if (header->fanout[b] < header->fanout[b - 1]) {
+			return false; // Find would search a negative range
+		}
+	}
+
+	const AssetPackEntry* entries = reinterpret_cast<const AssetPackEntry*>(data + sizeof(AssetPackHeader));
+	for (uint32_t i = 0; i < header->entryCount; i++) {
+		if (entries[i].offset > size || entries[i].size > size - entries[i].offset) {
+			return false; // Payload runs past the end of the file
+		}
+		if (i > 0 && entries[i].hash < entries[i - 1].hash) {
+			return false; // The binary search needs the index sorted
+		}
+	}
+	return true;
+}
\ No newline at end of file
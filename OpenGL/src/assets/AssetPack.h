@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Layout of a .pack file:
+//   AssetPackHeader
+//   AssetPackEntry[entryCount], sorted by hash
+//   payloads, each starting on an ASSET_PACK_ALIGNMENT boundary
+const uint32_t ASSET_PACK_MAGIC = 0x4B415047; // "GPAK"
+const uint32_t ASSET_PACK_VERSION = 1;
+const uint64_t ASSET_PACK_ALIGNMENT = 4096; // Payloads are page aligned so they can be handed to GL straight from the mapping
+
+struct AssetPackHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t reserved;
+	uint32_t fanout[256]; // fanout[b] = number of entries whose hash top byte is <= b
+};
+
+struct AssetPackEntry {
+	uint64_t hash; // FNV-1a hash of the asset path (e.g. "res/shaders/Basic.shader")
+	uint64_t offset; // Offset of the payload from the start of the file
+	uint64_t size; // Size of the payload in bytes
+};
+
+// Non-owning view of an asset payload inside a mapped pack
+struct AssetView {
+	const unsigned char* data;
+	size_t size;
+
+	inline bool IsValid() const { return data != nullptr; }
+};
+
+class AssetPack {
+private:
+	std::string m_FilePath;
+	MappedFile m_File;
+	const AssetPackHeader* m_Header;
+	const AssetPackEntry* m_Entries;
+public:
+	AssetPack(const std::string& filepath); // Maps the pack file, IsOpen() is false if it is missing or invalid
+
+	AssetPack(const AssetPack&) = delete;
+	AssetPack& operator=(const AssetPack&) = delete;
+
+	AssetView Find(const std::string& name) const; // Returns an invalid view if the asset is not in the pack
+
+	inline bool IsOpen() const { return m_Header != nullptr; }
+	inline unsigned int GetEntryCount() const { return IsOpen() ? m_Header->entryCount : 0; }
+
+	static uint64_t HashName(const std::string& name);
+	// Cooks the given loose files into a pack at outputPath, files are keyed by the path as written
+	static bool Build(const std::string& outputPath, const std::vector<std::string>& files);
+private:
+	bool Validate() const;
+};
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+	: m_Data(nullptr), m_Size(0),
+#ifdef _WIN32
+	m_FileHandle(nullptr), m_MappingHandle(nullptr)
+#else
+	m_FileDescriptor(-1)
+#endif
+{
+}
+
+MappedFile::MappedFile(const std::string& filepath)
+	: MappedFile()
+{
+	Open(filepath);
+}
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& filepath) {
+	Close();
+
+	HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_FileHandle = file;
+	m_MappingHandle = mapping;
+	m_Data = static_cast<const unsigned char*>(view);
+	m_Size = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (m_Data) {
+		UnmapViewOfFile(m_Data);
+	}
+	if (m_MappingHandle) {
+		CloseHandle(m_MappingHandle);
+	}
+	if (m_FileHandle) {
+		CloseHandle(m_FileHandle);
+	}
+	m_FileHandle = nullptr;
+	m_MappingHandle = nullptr;
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& filepath) {
+	Close();
+
+	int fd = open(filepath.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (view == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+
+	m_FileDescriptor = fd;
+	m_Data = static_cast<const unsigned char*>(view);
+	m_Size = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (m_Data) {
+		munmap(const_cast<unsigned char*>(m_Data), m_Size);
+	}
+	if (m_FileDescriptor >= 0) {
+		close(m_FileDescriptor);
+	}
+	m_FileDescriptor = -1;
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+#endif
\ No newline at end of file
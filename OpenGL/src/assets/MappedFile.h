@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The pages are loaded on first touch, so parsers
+// can walk the file without reading it into a buffer first.
+class MappedFile {
+private:
+	const unsigned char* m_Data;
+	size_t m_Size;
+#ifdef _WIN32
+	void* m_FileHandle;
+	void* m_MappingHandle;
+#else
+	int m_FileDescriptor;
+#endif
+public:
+	MappedFile();
+	MappedFile(const std::string& filepath); // IsOpen() is false if the file is missing or empty
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::string& filepath);
+	void Close();
+
+	inline bool IsOpen() const { return m_Data != nullptr; }
+	inline const unsigned char* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+};
\ No newline at end of file
@@ -1,12 +1,69 @@
 #include "IndexBuffer.h"
 #include "../Renderer.h"
 
+#include <algorithm>
+#include <vector>
+
+// Copies indices into a narrower type, the caller has checked every value fits
+template<typename T>
+static std::vector<T> NarrowIndices(const unsigned int* data, unsigned int count) {
+	std::vector<T> narrowed(count);
+	for (unsigned int i = 0; i < count; i++) {
+		narrowed[i] = (T)data[i];
+	}
+	return narrowed;
+}
+
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	: m_Count(count) // Initialize the count of indices
 {
+	if (GetNarrowestType(data, count) == GL_UNSIGNED_SHORT) {
+		std::vector<GLushort> narrowed = NarrowIndices<GLushort>(data, count);
+		Create(narrowed.data(), count, GL_UNSIGNED_SHORT, GL_STATIC_DRAW);
+	}
+	else {
+		Create(data, count, GL_UNSIGNED_INT, GL_STATIC_DRAW);
+	}
+}
+
+IndexBuffer::IndexBuffer(const unsigned short* data, unsigned int count)
+	: m_Count(count) // Initialize the count of indices
+{
+	Create(data, count, GL_UNSIGNED_SHORT, GL_STATIC_DRAW);
+}
+
+IndexBuffer::IndexBuffer(const unsigned char* data, unsigned int count)
+	: m_Count(count) // Initialize the count of indices
+{
+	Create(data, count, GL_UNSIGNED_BYTE, GL_STATIC_DRAW);
+}
+
+IndexBuffer::IndexBuffer(unsigned int count, BufferUsage usage, unsigned int type)
+	: m_Count(count) // Initialize the count of indices
+{
+	Create(nullptr, count, type, GetUsageHint(usage)); // Allocate storage, contents come later
+}
+
+void IndexBuffer::Create(const void* data, unsigned int count, unsigned int type, unsigned int usageHint)
+{
+	ASSERT(GetSizeOfType(type) != 0);
+	m_Type = type;
+	if (GLHasDirectStateAccess()) {
+		// No bind needed, so creating an index buffer no longer replaces the element buffer of the bound VAO
+		GLCall(glCreateBuffers(1, &m_RendererID));
+		if (usageHint == GL_STATIC_DRAW) {
+			// Immutable storage rejects a zero size, an empty buffer gets one uninitialized byte
+			GLCall(glNamedBufferStorage(m_RendererID, std::max(count * GetSizeOfType(type), 1u), count ? data : nullptr, GL_DYNAMIC_STORAGE_BIT));
+		}
+		else {
+			GLCall(glNamedBufferData(m_RendererID, count * GetSizeOfType(type), data, usageHint));
+		}
+		return;
+	}
+
 	GLCall(glGenBuffers(1, &m_RendererID)); // Generate a buffer ID
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID)); // Bind the buffer to the GL_ARRAY_BUFFER target
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(GLuint), data, GL_STATIC_DRAW)); // Upload the vertex data to the buffer
+	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID)); // Bind the buffer to the GL_ELEMENT_ARRAY_BUFFER target
+	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * GetSizeOfType(type), data, usageHint)); // Upload the index data to the buffer
 }
 
 IndexBuffer::~IndexBuffer()
@@ -14,6 +71,24 @@ IndexBuffer::~IndexBuffer()
 	GLCall(glDeleteBuffers(1, &m_RendererID)); // Delete the buffer
 }
 
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Count(other.m_Count), m_Type(other.m_Type)
+{
+	other.m_RendererID = 0; // The moved-from buffer deletes nothing
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+	if (this != &other) {
+		GLCall(glDeleteBuffers(1, &m_RendererID)); // Release the buffer we are replacing
+		m_RendererID = other.m_RendererID;
+		m_Count = other.m_Count;
+		m_Type = other.m_Type;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
 void IndexBuffer::Bind() const
 {
 	// Bind the vertex buffer to the GL_ARRAY_BUFFER target
@@ -24,4 +99,59 @@ void IndexBuffer::Unbind() const
 {
 	// Unbind the vertex buffer by binding 0 to the GL_ARRAY_BUFFER target
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+}
+
+void IndexBuffer::SetData(unsigned int first, const unsigned int* data, unsigned int count)
+{
+	ASSERT(first + count <= m_Count);
+	ASSERT(count == 0 || *std::max_element(data, data + count) <= GetMaxIndex(m_Type));
+
+	const unsigned int size = GetSizeOfType(m_Type);
+	if (m_Type == GL_UNSIGNED_INT) {
+		Upload(first * size, count * size, data);
+	}
+	else if (m_Type == GL_UNSIGNED_SHORT) {
+		std::vector<GLushort> narrowed = NarrowIndices<GLushort>(data, count);
+		Upload(first * size, count * size, narrowed.data());
+	}
+	else {
+		std::vector<GLubyte> narrowed = NarrowIndices<GLubyte>(data, count);
+		Upload(first * size, count * size, narrowed.data());
+	}
+}
+
+void IndexBuffer::Upload(unsigned int offset, unsigned int size, const void* data)
+{
+	if (GLHasDirectStateAccess()) {
+		GLCall(glNamedBufferSubData(m_RendererID, offset, size, data));
+		return;
+	}
+	Bind();
+	GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset, size, data));
+}
+
+unsigned int IndexBuffer::GetSizeOfType(unsigned int type)
+{
+	switch (type) {
+		case GL_UNSIGNED_INT:   return sizeof(GLuint);
+		case GL_UNSIGNED_SHORT: return sizeof(GLushort);
+		case GL_UNSIGNED_BYTE:  return sizeof(GLubyte);
+		default:                return 0; // Unsupported type
+	}
+}
+
+unsigned int IndexBuffer::GetMaxIndex(unsigned int type)
+{
+	switch (type) {
+		case GL_UNSIGNED_SHORT: return 0xFFFF;
+		case GL_UNSIGNED_BYTE:  return 0xFF;
+		default:                return 0xFFFFFFFF;
+	}
+}
+
+unsigned int IndexBuffer::GetNarrowestType(const unsigned int* data, unsigned int count)
+{
+	// 8-bit indices are never picked automatically, many GPUs convert them on the CPU or in a slow path
+	unsigned int maxIndex = count == 0 ? 0 : *std::max_element(data, data + count);
+	return maxIndex <= GetMaxIndex(GL_UNSIGNED_SHORT) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 }
\ No newline at end of file
@@ -1,16 +1,41 @@
 #pragma once
 
+#include <GL/glew.h>
+
+#include "VertexBuffer.h" // BufferUsage
 
 class IndexBuffer {
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
+	unsigned int m_Type; // GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
 public:
+	// Stored as 16-bit indices whenever every index fits, halving index bandwidth for small meshes
 	IndexBuffer(const unsigned int* data, unsigned int count);// Constructor to create a Index buffer with given data and size
+	IndexBuffer(const unsigned short* data, unsigned int count);
+	IndexBuffer(const unsigned char* data, unsigned int count);
+	IndexBuffer(unsigned int count, BufferUsage usage, unsigned int type = GL_UNSIGNED_INT);// Constructor to allocate room for count indices, filled later with SetData
 	~IndexBuffer();// Destructor to clean up the Index buffer
 
+	// GL names are owned, so the buffer can move but never be copied
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+	IndexBuffer(IndexBuffer&& other) noexcept;
+	IndexBuffer& operator=(IndexBuffer&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
 
+	void SetData(unsigned int first, const unsigned int* data, unsigned int count); // Updates indices [first, first + count), narrowed to the buffer's type
+
 	inline unsigned int GetCount() const { return m_Count; } // Returns the count of indices in the buffer
+	inline unsigned int GetType() const { return m_Type; } // Index type to pass to glDrawElements
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	static unsigned int GetSizeOfType(unsigned int type);
+	static unsigned int GetMaxIndex(unsigned int type); // Largest index the type can hold
+	static unsigned int GetNarrowestType(const unsigned int* data, unsigned int count); // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+private:
+	void Create(const void* data, unsigned int count, unsigned int type, unsigned int usageHint);
+	void Upload(unsigned int offset, unsigned int size, const void* data); // Byte range update
 };
\ No newline at end of file
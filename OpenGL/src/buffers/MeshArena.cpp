@@ -0,0 +1,129 @@
+#include "MeshArena.h"
+#include "../Renderer.h"
+
+static void CopyBufferRange(unsigned int source, unsigned int destination, unsigned int sourceOffset, unsigned int destinationOffset, unsigned int size) {
+	if (GLHasDirectStateAccess()) {
+		GLCall(glCopyNamedBufferSubData(source, destination, sourceOffset, destinationOffset, size));
+		return;
+	}
+	GLCall(glBindBuffer(GL_COPY_READ_BUFFER, source));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, destination));
+	GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, size));
+}
+
+MeshArena::MeshArena(const VertexBufferLayout& layout, unsigned int maxVertices, unsigned int maxIndices, unsigned int indexType)
+	: m_Layout(layout), m_VertexAllocator(maxVertices), m_IndexAllocator(maxIndices)
+{
+	m_VertexArray.Bind(); // Creating the index buffer binds it, make sure it lands in our VAO
+	m_VertexBuffer.reset(new VertexBuffer(maxVertices * layout.GetStride(), BufferUsage::Dynamic));
+	m_IndexBuffer.reset(new IndexBuffer(maxIndices, BufferUsage::Dynamic, indexType));
+
+	m_VertexArray.AddBuffer(*m_VertexBuffer, m_Layout);
+	m_VertexArray.SetIndexBuffer(*m_IndexBuffer); // The element buffer binding is VAO state, so one bind serves every mesh
+	m_VertexArray.Unbind();
+}
+
+MeshHandle MeshArena::Add(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount) {
+	ASSERT(vertexCount == 0 || vertexCount - 1 <= IndexBuffer::GetMaxIndex(m_IndexBuffer->GetType()));
+	// The allocators have no empty range to hand out, an empty side simply takes no space
+	unsigned int baseVertex = vertexCount > 0 ? m_VertexAllocator.Allocate(vertexCount) : 0;
+	if (baseVertex == RangeAllocator::INVALID_OFFSET) {
+		return { INVALID_ID, 0 };
+	}
+	unsigned int firstIndex = indexCount > 0 ? m_IndexAllocator.Allocate(indexCount) : 0;
+	if (firstIndex == RangeAllocator::INVALID_OFFSET) {
+		if (vertexCount > 0) {
+			m_VertexAllocator.Free(baseVertex, vertexCount);
+		}
+		return { INVALID_ID, 0 };
+	}
+
+	const unsigned int stride = m_Layout.GetStride();
+	if (vertexCount > 0) {
+		m_VertexBuffer->SetData(baseVertex * stride, vertices, vertexCount * stride);
+	}
+	if (indexCount > 0) {
+		m_VertexArray.Bind(); // Keep the index upload from replacing the element buffer of whatever VAO is bound
+		m_IndexBuffer->SetData(firstIndex, indices, indexCount);
+		m_VertexArray.Unbind();
+	}
+
+	const MeshRange range = { baseVertex, vertexCount, firstIndex, indexCount };
+	if (!m_FreeIds.empty()) {
+		unsigned int id = m_FreeIds.back();
+		m_FreeIds.pop_back();
+		m_Meshes[id].range = range; // Keeps the generation Remove bumped
+		m_Meshes[id].alive = true;
+		return { id, m_Meshes[id].generation };
+	}
+	m_Meshes.push_back({ range, 0, true });
+	return { (unsigned int)m_Meshes.size() - 1, 0 };
+}
+
+const MeshRange& MeshArena::GetRange(MeshHandle mesh) const {
+	ASSERT(IsValid(mesh)); // Removed, or the id now belongs to another mesh
+	return m_Meshes[mesh.id].range;
+}
+
+void MeshArena::Remove(MeshHandle mesh) {
+	ASSERT(IsValid(mesh));
+	const MeshRange& range = m_Meshes[mesh.id].range;
+	if (range.vertexCount > 0) {
+		m_VertexAllocator.Free(range.baseVertex, range.vertexCount);
+	}
+	if (range.indexCount > 0) {
+		m_IndexAllocator.Free(range.firstIndex, range.indexCount);
+	}
+	m_Meshes[mesh.id].alive = false;
+	m_Meshes[mesh.id].generation++; // Outstanding handles to this id go stale
+	m_FreeIds.push_back(mesh.id);
+}
+
+void MeshArena::Defragment() {
+	const unsigned int stride = m_Layout.GetStride();
+	const unsigned int indexSize = IndexBuffer::GetSizeOfType(m_IndexBuffer->GetType());
+	m_VertexArray.Bind(); // Creating the index buffer binds it, make sure it lands in our VAO
+	std::unique_ptr<VertexBuffer> vertexBuffer(new VertexBuffer(m_VertexBuffer->GetSize(), BufferUsage::Dynamic));
+	std::unique_ptr<IndexBuffer> indexBuffer(new IndexBuffer(m_IndexBuffer->GetCount(), BufferUsage::Dynamic, m_IndexBuffer->GetType()));
+
+	// GPU-side copies into the fresh buffers, nothing is read back to the CPU.
+	// Copying between two buffers also sidesteps the overlapping-range rule of glCopyBufferSubData.
+	unsigned int vertexCursor = 0;
+	unsigned int indexCursor = 0;
+	for (Mesh& mesh : m_Meshes) {
+		if (!mesh.alive) {
+			continue;
+		}
+		MeshRange& range = mesh.range;
+
+		CopyBufferRange(m_VertexBuffer->GetRendererID(), vertexBuffer->GetRendererID(),
+			range.baseVertex * stride, vertexCursor * stride, range.vertexCount * stride);
+		CopyBufferRange(m_IndexBuffer->GetRendererID(), indexBuffer->GetRendererID(),
+			range.firstIndex * indexSize, indexCursor * indexSize, range.indexCount * indexSize);
+
+		range.baseVertex = vertexCursor; // Indices are relative to the base vertex, so they don't need rewriting
+		range.firstIndex = indexCursor;
+		vertexCursor += range.vertexCount;
+		indexCursor += range.indexCount;
+	}
+	if (!GLHasDirectStateAccess()) {
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+		GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+	}
+
+	m_VertexBuffer = std::move(vertexBuffer);
+	m_IndexBuffer = std::move(indexBuffer);
+	m_VertexAllocator.Reset(vertexCursor);
+	m_IndexAllocator.Reset(indexCursor);
+
+	// Repoint the shared VAO at the new buffers
+	m_VertexArray.AddBuffer(*m_VertexBuffer, m_Layout);
+	m_VertexArray.SetIndexBuffer(*m_IndexBuffer);
+	m_VertexArray.Unbind();
+}
+
+void MeshArena::AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor) {
+	// Instance data sits on its own binding, Defragment only repoints the per-vertex one
+	m_VertexArray.AddInstanceBuffer(vb, layout, (unsigned int)m_Layout.GetElements().size(), divisor);
+	m_VertexArray.Unbind();
+}
\ No newline at end of file
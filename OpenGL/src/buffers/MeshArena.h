@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "RangeAllocator.h"
+
+// Stable reference to a mesh in a MeshArena, stays valid across Defragment(). The generation
+// changes whenever the id is reused, so a handle to a removed mesh never finds its replacement.
+struct MeshHandle {
+	unsigned int id;
+	unsigned int generation;
+};
+
+// Where a mesh lives inside the arena's shared buffers
+struct MeshRange {
+	unsigned int baseVertex; // Added to every index by glDrawElementsBaseVertex
+	unsigned int vertexCount;
+	unsigned int firstIndex;
+	unsigned int indexCount;
+};
+
+// Shares one vertex buffer, one index buffer and one VAO between many meshes with the
+// same layout. Meshes keep their own 0-based indices, draws offset them with a base vertex.
+class MeshArena {
+private:
+	struct Mesh {
+		MeshRange range;
+		unsigned int generation;
+		bool alive;
+	};
+
+	VertexBufferLayout m_Layout;
+	VertexArray m_VertexArray;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	RangeAllocator m_VertexAllocator; // In vertices
+	RangeAllocator m_IndexAllocator; // In indices
+	std::vector<Mesh> m_Meshes;
+	std::vector<unsigned int> m_FreeIds;
+public:
+	static const unsigned int INVALID_ID = 0xFFFFFFFF;
+
+	// Indices are relative to each mesh's base vertex, so GL_UNSIGNED_SHORT works for any arena whose meshes stay under 65536 vertices
+	MeshArena(const VertexBufferLayout& layout, unsigned int maxVertices, unsigned int maxIndices, unsigned int indexType = GL_UNSIGNED_INT);
+
+	MeshArena(const MeshArena&) = delete;
+	MeshArena& operator=(const MeshArena&) = delete;
+
+	// Copies the mesh into the shared buffers, returns a handle with INVALID_ID if the arena is full.
+	// An empty mesh (no vertices or no indices) takes no space and draws nothing.
+	MeshHandle Add(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Remove(MeshHandle mesh);
+
+	// Moves every live mesh to the front of fresh buffers, closing the holes left by Remove
+	void Defragment();
+
+	// Per-instance attributes at the locations after the arena's own layout, kept across Defragment
+	void AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor = 1);
+
+	inline bool IsValid(MeshHandle mesh) const {
+		return mesh.id < m_Meshes.size() && m_Meshes[mesh.id].alive && m_Meshes[mesh.id].generation == mesh.generation;
+	}
+	const MeshRange& GetRange(MeshHandle mesh) const; // Asserts the handle is valid
+
+	inline const VertexArray& GetVertexArray() const { return m_VertexArray; }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_IndexBuffer; }
+	inline const RangeAllocator& GetVertexAllocator() const { return m_VertexAllocator; }
+	inline const RangeAllocator& GetIndexAllocator() const { return m_IndexAllocator; }
+};
\ No newline at end of file
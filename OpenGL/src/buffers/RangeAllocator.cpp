@@ -0,0 +1,97 @@
+#include "RangeAllocator.h"
+#include "../Renderer.h"
+
+#include <algorithm>
+
+RangeAllocator::RangeAllocator(unsigned int capacity)
+	: m_Capacity(capacity), m_Used(0)
+{
+	Reset(0);
+}
+
+unsigned int RangeAllocator::Allocate(unsigned int size) {
+	if (size == 0) {
+		return INVALID_OFFSET;
+	}
+
+	// Best fit keeps large blocks intact for large meshes
+	size_t best = m_FreeBlocks.size();
+	for (size_t i = 0; i < m_FreeBlocks.size(); i++) {
+		if (m_FreeBlocks[i].size >= size && (best == m_FreeBlocks.size() || m_FreeBlocks[i].size < m_FreeBlocks[best].size)) {
+			best = i;
+			if (m_FreeBlocks[i].size == size) {
+				break; // Exact fit, can't do better
+			}
+		}
+	}
+	if (best == m_FreeBlocks.size()) {
+		return INVALID_OFFSET;
+	}
+
+	Block& block = m_FreeBlocks[best];
+	unsigned int offset = block.offset;
+	block.offset += size;
+	block.size -= size;
+	if (block.size == 0) {
+		m_FreeBlocks.erase(m_FreeBlocks.begin() + best);
+	}
+
+	m_Used += size;
+	return offset;
+}
+
+void RangeAllocator::Free(unsigned int offset, unsigned int size) {
+	ASSERT(offset + size <= m_Capacity && size <= m_Used);
+	m_Used -= size;
+
+	auto next = std::lower_bound(m_FreeBlocks.begin(), m_FreeBlocks.end(), offset,
+		[](const Block& block, unsigned int value) { return block.offset < value; });
+
+	// Merge with the block that ends where this one starts
+	if (next != m_FreeBlocks.begin()) {
+		auto previous = next - 1;
+		ASSERT(previous->offset + previous->size <= offset); // Double free or overlapping range
+		if (previous->offset + previous->size == offset) {
+			previous->size += size;
+			if (next != m_FreeBlocks.end() && previous->offset + previous->size == next->offset) {
+				previous->size += next->size; // Closed the gap between two free blocks
+				m_FreeBlocks.erase(next);
+			}
+			return;
+		}
+	}
+
+	// Merge with the block that starts where this one ends
+	if (next != m_FreeBlocks.end() && offset + size == next->offset) {
+		next->offset = offset;
+		next->size += size;
+		return;
+	}
+
+	m_FreeBlocks.insert(next, { offset, size });
+}
+
+void RangeAllocator::Reset(unsigned int used) {
+	ASSERT(used <= m_Capacity);
+	m_FreeBlocks.clear();
+	if (used < m_Capacity) {
+		m_FreeBlocks.push_back({ used, m_Capacity - used });
+	}
+	m_Used = used;
+}
+
+unsigned int RangeAllocator::GetLargestFreeBlock() const {
+	unsigned int largest = 0;
+	for (const Block& block : m_FreeBlocks) {
+		largest = std::max(largest, block.size);
+	}
+	return largest;
+}
+
+float RangeAllocator::GetFragmentation() const {
+	unsigned int free = m_Capacity - m_Used;
+	if (free == 0) {
+		return 0.0f;
+	}
+	return 1.0f - (float)GetLargestFreeBlock() / (float)free;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+
+// Offset allocator over a fixed range [0, capacity). Knows nothing about GL, units
+// are whatever the owner wants (vertices, indices, bytes). Free blocks are kept
+// sorted by offset so neighbours are merged on release.
+class RangeAllocator {
+private:
+	struct Block {
+		unsigned int offset;
+		unsigned int size;
+	};
+
+	std::vector<Block> m_FreeBlocks; // Sorted by offset, never adjacent
+	unsigned int m_Capacity;
+	unsigned int m_Used;
+public:
+	static const unsigned int INVALID_OFFSET = 0xFFFFFFFF;
+
+	RangeAllocator(unsigned int capacity);
+
+	unsigned int Allocate(unsigned int size); // Best fit, returns INVALID_OFFSET when no block is large enough
+	void Free(unsigned int offset, unsigned int size);
+	void Reset(unsigned int used); // Marks [0, used) as allocated and the rest as free, used after compaction
+
+	inline unsigned int GetCapacity() const { return m_Capacity; }
+	inline unsigned int GetUsed() const { return m_Used; }
+	unsigned int GetLargestFreeBlock() const;
+	float GetFragmentation() const; // 0 when all free space is one block, approaching 1 as it splinters
+};
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "RingBuffer.h"
+#include "../Renderer.h"
+
+#include <cstring>
+
+RingBuffer::RingBuffer(unsigned int frameSize, unsigned int frameCount)
+	: m_RendererID(0), m_MappedData(nullptr), m_FrameSize(frameSize), m_FrameCount(frameCount),
+	m_CurrentFrame(0), m_FrameOffset(0), m_Fences{}
+{
+	ASSERT(IsSupported());
+	ASSERT(frameCount > 0 && frameCount <= RING_BUFFER_MAX_FRAMES);
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr size = (GLsizeiptr)frameSize * frameCount;
+
+	if (GLHasDirectStateAccess()) {
+		GLCall(glCreateBuffers(1, &m_RendererID));
+		GLCall(glNamedBufferStorage(m_RendererID, size, nullptr, flags)); // Immutable storage, allocated once
+		GLCall(m_MappedData = static_cast<unsigned char*>(glMapNamedBufferRange(m_RendererID, 0, size, flags)));
+		return;
+	}
+
+	GLCall(glGenBuffers(1, &m_RendererID)); // Generate a buffer ID
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID)); // Neutral target so no vertex or index binding is disturbed
+	GLCall(glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags)); // Immutable storage, allocated once
+	GLCall(m_MappedData = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags)));
+	GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+}
+
+RingBuffer::~RingBuffer() {
+	for (unsigned int i = 0; i < m_FrameCount; i++) {
+		if (m_Fences[i]) {
+			GLCall(glDeleteSync(static_cast<GLsync>(m_Fences[i])));
+		}
+	}
+	// Deleting a buffer unmaps it, persistent mappings don't need an explicit glUnmapBuffer
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+bool RingBuffer::IsSupported() {
+	return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+void RingBuffer::BeginFrame() {
+	m_CurrentFrame = (m_CurrentFrame + 1) % m_FrameCount;
+	m_FrameOffset = 0;
+
+	GLsync fence = static_cast<GLsync>(m_Fences[m_CurrentFrame]);
+	if (!fence) {
+		return; // Region never submitted, nothing to wait for
+	}
+
+	// With enough regions this returns immediately, it only blocks when the CPU runs a full ring ahead
+	GLbitfield waitFlags = 0;
+	GLuint64 timeout = 0;
+	while (true) {
+		GLenum result = glClientWaitSync(fence, waitFlags, timeout);
+		if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED) {
+			ASSERT(result != GL_WAIT_FAILED);
+			break;
+		}
+		waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT; // Make sure the fence actually reaches the GPU
+		timeout = 1000000; // 1 ms in nanoseconds
+	}
+
+	GLCall(glDeleteSync(fence));
+	m_Fences[m_CurrentFrame] = nullptr;
+}
+
+void RingBuffer::EndFrame() {
+	GLCall(m_Fences[m_CurrentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+RingAllocation RingBuffer::Allocate(unsigned int size, unsigned int alignment) {
+	ASSERT(alignment > 0);
+	unsigned int frameStart = m_CurrentFrame * m_FrameSize;
+	// Align the absolute offset, frame regions don't have to start on an alignment boundary
+	unsigned int offset = (frameStart + m_FrameOffset + alignment - 1) / alignment * alignment - frameStart;
+
+	if (offset + size > m_FrameSize) {
+		return { nullptr, 0, 0 }; // Region exhausted, the caller should size the ring for its worst frame
+	}
+
+	m_FrameOffset = offset + size;
+	return { m_MappedData + frameStart + offset, frameStart + offset, size };
+}
+
+RingAllocation RingBuffer::Write(const void* data, unsigned int size, unsigned int alignment) {
+	RingAllocation allocation = Allocate(size, alignment);
+	if (allocation.IsValid()) {
+		memcpy(allocation.data, data, size); // Coherent mapping, visible to the GPU without a flush
+	}
+	return allocation;
+}
+
+void RingBuffer::Bind(unsigned int target) const {
+	GLCall(glBindBuffer(target, m_RendererID));
+}
+
+void RingBuffer::BindRange(unsigned int target, unsigned int index, const RingAllocation& allocation) const {
+	GLCall(glBindBufferRange(target, index, m_RendererID, allocation.offset, allocation.size));
+}
+
+unsigned int RingBuffer::GetUniformAlignment() {
+	int alignment = 0;
+	GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+	return (unsigned int)alignment;
+}
\ No newline at end of file
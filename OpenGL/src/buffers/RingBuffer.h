@@ -0,0 +1,51 @@
+#pragma once
+
+const unsigned int RING_BUFFER_MAX_FRAMES = 8;
+
+// A slice of the ring handed out for the current frame
+struct RingAllocation {
+	void* data; // Write pointer into the persistent mapping, nullptr if the frame region is full
+	unsigned int offset; // Byte offset from the start of the buffer, for bind ranges and draw offsets
+	unsigned int size;
+
+	inline bool IsValid() const { return data != nullptr; }
+};
+
+// Persistently mapped buffer (GL 4.4 / ARB_buffer_storage) split into frameCount regions.
+// Each frame writes into its own region, a fence per region keeps the CPU from
+// overwriting data the GPU is still reading. Writing is a plain memcpy, no GL calls.
+class RingBuffer {
+private:
+	unsigned int m_RendererID;
+	unsigned char* m_MappedData;
+	unsigned int m_FrameSize; // Size of one frame region in bytes
+	unsigned int m_FrameCount;
+	unsigned int m_CurrentFrame;
+	unsigned int m_FrameOffset; // Bytes used in the current frame region
+	void* m_Fences[RING_BUFFER_MAX_FRAMES]; // GLsync per region, stored as void* to keep GL types out of the header
+public:
+	RingBuffer(unsigned int frameSize, unsigned int frameCount = 3);
+	~RingBuffer();
+
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	static bool IsSupported(); // Whether the context can create persistent mapped storage
+
+	void BeginFrame(); // Advances to the next region, waiting only if the GPU hasn't finished with it yet
+	void EndFrame(); // Fences the current region after the frame's draws have been submitted
+
+	// Reserves size bytes in the current region. Any alignment works, pass the vertex stride
+	// for vertex data so allocation.offset / stride can be used as the base vertex of a draw
+	RingAllocation Allocate(unsigned int size, unsigned int alignment = 16);
+	RingAllocation Write(const void* data, unsigned int size, unsigned int alignment = 16);
+
+	void Bind(unsigned int target) const; // e.g. GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+	void BindRange(unsigned int target, unsigned int index, const RingAllocation& allocation) const; // e.g. GL_UNIFORM_BUFFER
+
+	static unsigned int GetUniformAlignment(); // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, pass to Allocate for uniform blocks
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetFrameSize() const { return m_FrameSize; }
+	inline unsigned int GetFrameCount() const { return m_FrameCount; }
+};
\ No newline at end of file
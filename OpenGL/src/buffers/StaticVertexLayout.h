@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <GL/glew.h>
+
+#include "glm/glm.hpp"
+#include "glm/ext/vector_int2_sized.hpp"
+#include "glm/ext/vector_int4_sized.hpp"
+#include "glm/ext/vector_uint2_sized.hpp"
+#include "glm/ext/vector_uint4_sized.hpp"
+
+#include "VertexBufferLayout.h" // Half, Packed1010102
+
+// Compile-time vertex layouts, described straight from the members of a vertex struct:
+//
+//     struct QuadVertex { glm::vec2 position; glm::vec2 texCoord; };
+//     constexpr auto QUAD_LAYOUT = MakeVertexLayout<QuadVertex>(
+//         VERTEX_ATTRIBUTE(QuadVertex, position),
+//         VERTEX_ATTRIBUTE(QuadVertex, texCoord));
+//
+// The GL type, component count and normalization come from the member's C++ type, so a
+// member type without a mapping below fails to compile, and overlapping or out of bounds
+// attributes fail the constant evaluation. The result is a fixed-size array, no allocation.
+
+struct VertexAttribute {
+	unsigned int type; // GL data type (e.g., GL_FLOAT)
+	unsigned int count; // Number of components
+	unsigned char normalized; // Whether the data should be normalized
+	unsigned char integer; // Whether the shader reads it as an int/uint attribute
+	unsigned int offset; // Byte offset inside the vertex
+	unsigned int size; // Byte size of the member
+};
+
+// Maps a member type to its vertex attribute format. Only types listed here compile.
+template<typename T>
+struct VertexAttributeFormat;
+
+#define VERTEX_ATTRIBUTE_FORMAT(CppType, GLType, Count, Normalized, Integer) \
+	template<> struct VertexAttributeFormat<CppType> { \
+		static constexpr unsigned int type = GLType; \
+		static constexpr unsigned int count = Count; \
+		static constexpr bool normalized = Normalized; \
+		static constexpr bool integer = Integer; \
+	}
+
+VERTEX_ATTRIBUTE_FORMAT(float,            GL_FLOAT, 1, false, false);
+VERTEX_ATTRIBUTE_FORMAT(glm::vec2,        GL_FLOAT, 2, false, false);
+VERTEX_ATTRIBUTE_FORMAT(glm::vec3,        GL_FLOAT, 3, false, false);
+VERTEX_ATTRIBUTE_FORMAT(glm::vec4,        GL_FLOAT, 4, false, false);
+VERTEX_ATTRIBUTE_FORMAT(int,              GL_INT, 1, false, true);
+VERTEX_ATTRIBUTE_FORMAT(glm::ivec2,       GL_INT, 2, false, true);
+VERTEX_ATTRIBUTE_FORMAT(glm::ivec3,       GL_INT, 3, false, true);
+VERTEX_ATTRIBUTE_FORMAT(glm::ivec4,       GL_INT, 4, false, true);
+VERTEX_ATTRIBUTE_FORMAT(unsigned int,     GL_UNSIGNED_INT, 1, false, true);
+VERTEX_ATTRIBUTE_FORMAT(glm::uvec2,       GL_UNSIGNED_INT, 2, false, true);
+VERTEX_ATTRIBUTE_FORMAT(glm::uvec3,       GL_UNSIGNED_INT, 3, false, true);
+VERTEX_ATTRIBUTE_FORMAT(glm::uvec4,       GL_UNSIGNED_INT, 4, false, true);
+VERTEX_ATTRIBUTE_FORMAT(glm::i16vec2,     GL_SHORT, 2, true, false);
+VERTEX_ATTRIBUTE_FORMAT(glm::i16vec4,     GL_SHORT, 4, true, false);
+VERTEX_ATTRIBUTE_FORMAT(glm::u16vec2,     GL_UNSIGNED_SHORT, 2, true, false);
+VERTEX_ATTRIBUTE_FORMAT(glm::u16vec4,     GL_UNSIGNED_SHORT, 4, true, false);
+VERTEX_ATTRIBUTE_FORMAT(glm::i8vec4,      GL_BYTE, 4, true, false);
+VERTEX_ATTRIBUTE_FORMAT(glm::u8vec4,      GL_UNSIGNED_BYTE, 4, true, false);
+VERTEX_ATTRIBUTE_FORMAT(Packed1010102,    GL_INT_2_10_10_10_REV, 4, true, false);
+
+#undef VERTEX_ATTRIBUTE_FORMAT
+
+// Half floats have no scalar C++ type, store them as arrays of Half
+template<size_t N>
+struct VertexAttributeFormat<Half[N]> {
+	static constexpr unsigned int type = GL_HALF_FLOAT;
+	static constexpr unsigned int count = N;
+	static constexpr bool normalized = false;
+	static constexpr bool integer = false;
+};
+
+template<typename T>
+constexpr VertexAttribute MakeVertexAttribute(size_t offset) {
+	return {
+		VertexAttributeFormat<T>::type,
+		VertexAttributeFormat<T>::count,
+		(unsigned char)(VertexAttributeFormat<T>::normalized ? GL_TRUE : GL_FALSE),
+		(unsigned char)(VertexAttributeFormat<T>::integer ? GL_TRUE : GL_FALSE),
+		(unsigned int)offset,
+		(unsigned int)sizeof(T)
+	};
+}
+
+// Describes one member of a vertex struct
+#define VERTEX_ATTRIBUTE(Vertex, member) MakeVertexAttribute<decltype(Vertex::member)>(offsetof(Vertex, member))
+
+template<size_t N>
+struct StaticVertexLayout {
+	VertexAttribute attributes[N];
+	unsigned int stride;
+
+	static constexpr size_t count = N;
+};
+
+// Not constexpr on purpose: reaching it during constant evaluation is a compile error
+inline bool InvalidVertexLayout() {
+	ASSERT(false);
+	return false;
+}
+
+// Every attribute must lie inside the vertex and no two may overlap
+template<size_t N>
+constexpr bool ValidateVertexLayout(const StaticVertexLayout<N>& layout) {
+	for (size_t i = 0; i < N; i++) {
+		const VertexAttribute& a = layout.attributes[i];
+		if (a.offset + a.size > layout.stride) {
+			return InvalidVertexLayout();
+		}
+		for (size_t j = i + 1; j < N; j++) {
+			const VertexAttribute& b = layout.attributes[j];
+			if (a.offset < b.offset + b.size && b.offset < a.offset + a.size) {
+				return InvalidVertexLayout();
+			}
+		}
+	}
+	return true;
+}
+
+template<typename Vertex, typename... Attributes>
+constexpr StaticVertexLayout<sizeof...(Attributes)> MakeVertexLayout(Attributes... attributes) {
+	static_assert(sizeof...(Attributes) > 0, "A vertex layout needs at least one attribute");
+	StaticVertexLayout<sizeof...(Attributes)> layout = { { attributes... }, (unsigned int)sizeof(Vertex) };
+	ValidateVertexLayout(layout);
+	return layout;
+}
+
+// Runtime copy of a tightly packed layout, for what takes a VertexBufferLayout (VertexArrayCache, MeshArena)
+template<size_t N>
+inline VertexBufferLayout ToVertexBufferLayout(const StaticVertexLayout<N>& layout) {
+	VertexBufferLayout result;
+	for (const VertexAttribute& attribute : layout.attributes) {
+		ASSERT(attribute.offset == result.GetStride()); // VertexBufferLayout has no gaps between attributes
+		result.Push(attribute.type, attribute.count, attribute.normalized, attribute.integer);
+	}
+	ASSERT(result.GetStride() == layout.stride);
+	return result;
+}
\ No newline at end of file
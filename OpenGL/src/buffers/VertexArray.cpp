@@ -1,8 +1,15 @@
 #include "VertexArray.h"
 #include "VertexBufferLayout.h"
+#include "IndexBuffer.h"
+#include "RingBuffer.h"
+#include "StaticVertexLayout.h"
 #include "../Renderer.h"
 
 VertexArray::VertexArray() {
+	if (GLHasDirectStateAccess()) {
+		GLCall(glCreateVertexArrays(1, &m_RendererID)); // Create the VAO, it is edited by name and never has to be bound for setup
+		return;
+	}
 	GLCall(glGenVertexArrays(1, &m_RendererID)); // Generate a Vertex Array Object (VAO)
 }
 
@@ -10,16 +17,109 @@ VertexArray::~VertexArray() {
 	GLCall(glDeleteVertexArrays(1, &m_RendererID)); // Delete the VAO
 }
 
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	: m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0; // The moved-from VAO deletes nothing
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
+	if (this != &other) {
+		GLCall(glDeleteVertexArrays(1, &m_RendererID)); // Release the VAO we are replacing
+		m_RendererID = other.m_RendererID;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout) {
+	AttachBuffer(vb.GetRendererID(), layout.GetStride());
+	SetLayout(layout);
+}
+
+void VertexArray::AddBuffer(const RingBuffer& rb, const VertexBufferLayout& layout) {
+	AttachBuffer(rb.GetRendererID(), layout.GetStride());
+	SetLayout(layout);
+}
+
+void VertexArray::AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor) {
+	AttachInstances(vb.GetRendererID(), layout, firstAttribute, divisor);
+}
+
+void VertexArray::AddInstanceBuffer(const RingBuffer& rb, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor) {
+	AttachInstances(rb.GetRendererID(), layout, firstAttribute, divisor);
+}
+
+void VertexArray::AttachInstances(unsigned int bufferID, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor) {
+	const unsigned int binding = 1; // Per-vertex data stays on binding 0
+	AttachBuffer(bufferID, layout.GetStride(), binding);
+	SetLayout(layout, firstAttribute, binding);
+
+	if (GLHasDirectStateAccess()) {
+		GLCall(glVertexArrayBindingDivisor(m_RendererID, binding, divisor)); // The divisor lives on the binding
+		return;
+	}
+	for (unsigned int i = 0; i < layout.GetElements().size(); i++) {
+		GLCall(glVertexAttribDivisor(firstAttribute + i, divisor));
+	}
+}
+
+void VertexArray::SetIndexBuffer(const IndexBuffer& ib) {
+	if (GLHasDirectStateAccess()) {
+		GLCall(glVertexArrayElementBuffer(m_RendererID, ib.GetRendererID()));
+		return;
+	}
+	Bind(); // The element buffer binding is VAO state
+	ib.Bind();
+}
+
+void VertexArray::AttachBuffer(unsigned int bufferID, unsigned int stride, unsigned int binding) {
+	if (GLHasDirectStateAccess()) {
+		// Attributes read from a binding point, the stride lives on the binding
+		GLCall(glVertexArrayVertexBuffer(m_RendererID, binding, bufferID, 0, stride));
+		return;
+	}
 	Bind(); // Bind the VAO before adding buffers
-	vb.Bind();
+	GLCall(glBindBuffer(GL_ARRAY_BUFFER, bufferID)); // glVertexAttribPointer captures the bound GL_ARRAY_BUFFER
+}
+
+void VertexArray::SetLayout(const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int binding) {
 	const auto& elements = layout.GetElements();
 	unsigned int offset = 0;
 	for (unsigned int i = 0; i < elements.size(); i++) {
 		const auto& element = elements[i];
-		glEnableVertexAttribArray(i);
-		glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset);
-		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+		SetAttribute(firstAttribute + i, element.type, element.count, element.normalized == GL_TRUE, element.integer == GL_TRUE, layout.GetStride(), offset, binding);
+		offset += element.GetSize();
+	}
+}
+
+void VertexArray::SetAttributes(const VertexAttribute* attributes, unsigned int count, unsigned int stride) {
+	for (unsigned int i = 0; i < count; i++) {
+		const VertexAttribute& attribute = attributes[i];
+		SetAttribute(i, attribute.type, attribute.count, attribute.normalized == GL_TRUE, attribute.integer == GL_TRUE, stride, attribute.offset);
+	}
+}
+
+void VertexArray::SetAttribute(unsigned int index, unsigned int type, unsigned int count, bool normalized, bool integer, unsigned int stride, unsigned int offset, unsigned int binding) {
+	if (GLHasDirectStateAccess()) {
+		GLCall(glEnableVertexArrayAttrib(m_RendererID, index));
+		if (integer) {
+			GLCall(glVertexArrayAttribIFormat(m_RendererID, index, count, type, offset));
+		}
+		else {
+			GLCall(glVertexArrayAttribFormat(m_RendererID, index, count, type, normalized ? GL_TRUE : GL_FALSE, offset));
+		}
+		GLCall(glVertexArrayAttribBinding(m_RendererID, index, binding));
+		return;
+	}
+
+	GLCall(glEnableVertexAttribArray(index));
+	if (integer) {
+		// Integer attributes skip the float conversion and keep their exact values
+		GLCall(glVertexAttribIPointer(index, count, type, stride, (const void*)(size_t)offset));
+	}
+	else {
+		GLCall(glVertexAttribPointer(index, count, type, normalized ? GL_TRUE : GL_FALSE, stride, (const void*)(size_t)offset));
 	}
 }
 
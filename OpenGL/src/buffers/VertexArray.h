@@ -1,8 +1,14 @@
 #pragma once
 
+#include <cstddef>
+
 #include "VertexBuffer.h"
 
 class VertexBufferLayout;
+class IndexBuffer;
+class RingBuffer;
+struct VertexAttribute;
+template<size_t N> struct StaticVertexLayout; // See StaticVertexLayout.h
 
 class VertexArray {
 private:
@@ -11,8 +17,35 @@ public:
 	VertexArray();
 	~VertexArray();
 
+	// GL names are owned, so the VAO can move but never be copied
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	void AddBuffer(const RingBuffer& rb, const VertexBufferLayout& layout); // Attributes start at the ring's beginning, draws select data with a base vertex
+
+	// Offsets and stride were computed at compile time, nothing is accumulated or allocated here
+	template<size_t N>
+	void AddBuffer(const VertexBuffer& vb, const StaticVertexLayout<N>& layout) {
+		AttachBuffer(vb.GetRendererID(), layout.stride);
+		SetAttributes(layout.attributes, (unsigned int)N, layout.stride);
+	}
+
+	// Per-instance attributes starting at location firstAttribute, advancing once every divisor instances.
+	// A mat4 is pushed as 4 float vec4s and takes 4 locations, see res/shaders/Instanced.shader
+	void AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor = 1);
+	void AddInstanceBuffer(const RingBuffer& rb, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor = 1); // Draws select the frame's slice with a base instance
+
+	void SetIndexBuffer(const IndexBuffer& ib); // Records ib as this VAO's element buffer
 
 	void Bind() const;
 	void Unbind() const;
+private:
+	void AttachBuffer(unsigned int bufferID, unsigned int stride, unsigned int binding = 0); // Makes bufferID the source of the attributes set next
+	void AttachInstances(unsigned int bufferID, const VertexBufferLayout& layout, unsigned int firstAttribute, unsigned int divisor);
+	void SetLayout(const VertexBufferLayout& layout, unsigned int firstAttribute = 0, unsigned int binding = 0);
+	void SetAttributes(const VertexAttribute* attributes, unsigned int count, unsigned int stride);
+	void SetAttribute(unsigned int index, unsigned int type, unsigned int count, bool normalized, bool integer, unsigned int stride, unsigned int offset, unsigned int binding = 0);
 };
\ No newline at end of file
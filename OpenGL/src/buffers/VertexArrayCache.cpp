@@ -0,0 +1,115 @@
+#include "VertexArrayCache.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "../Renderer.h"
+
+VertexArrayCache::VertexArrayCache()
+	: m_Lookup{ 0, {}, 0, 0, 0 }, m_UseAttribBinding(GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding), m_Hits(0), m_Misses(0)
+{
+}
+
+VertexArrayCache::~VertexArrayCache() {
+	Clear();
+}
+
+void VertexArrayCache::Bind(const VertexBuffer& vb, const IndexBuffer& ib, const VertexBufferLayout& layout) {
+	Key& key = m_Lookup;
+	key.layoutHash = layout.GetHash();
+	key.elements = layout.GetElements();
+	key.stride = layout.GetStride();
+	key.vertexBufferID = 0;
+	key.indexBufferID = 0;
+	if (!m_UseAttribBinding) {
+		// Without attribute binding the VAO captures the buffers, so they are part of the key
+		key.vertexBufferID = vb.GetRendererID();
+		key.indexBufferID = ib.GetRendererID();
+	}
+
+	unsigned int vao;
+	auto it = m_VertexArrays.find(key);
+	if (it != m_VertexArrays.end()) {
+		vao = it->second;
+		m_Hits++;
+	}
+	else {
+		vao = m_UseAttribBinding ? CreateFormatVertexArray(layout) : CreateBoundVertexArray(vb, ib, layout);
+		m_VertexArrays[key] = vao;
+		m_Misses++;
+	}
+
+	GLCall(glBindVertexArray(vao));
+	if (m_UseAttribBinding) {
+		// The shared VAO only holds formats, attach this mesh's buffers
+		GLCall(glBindVertexBuffer(0, vb.GetRendererID(), 0, layout.GetStride()));
+		ib.Bind();
+	}
+}
+
+unsigned int VertexArrayCache::CreateFormatVertexArray(const VertexBufferLayout& layout) {
+	unsigned int vao;
+	GLCall(glGenVertexArrays(1, &vao));
+	GLCall(glBindVertexArray(vao));
+
+	const auto& elements = layout.GetElements();
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < elements.size(); i++) {
+		const auto& element = elements[i];
+		GLCall(glEnableVertexAttribArray(i));
+		if (element.integer) {
+			GLCall(glVertexAttribIFormat(i, element.count, element.type, offset));
+		}
+		else {
+			GLCall(glVertexAttribFormat(i, element.count, element.type, element.normalized, offset));
+		}
+		GLCall(glVertexAttribBinding(i, 0)); // Every attribute reads from binding point 0
+		offset += element.GetSize();
+	}
+	return vao;
+}
+
+unsigned int VertexArrayCache::CreateBoundVertexArray(const VertexBuffer& vb, const IndexBuffer& ib, const VertexBufferLayout& layout) {
+	unsigned int vao;
+	GLCall(glGenVertexArrays(1, &vao));
+	GLCall(glBindVertexArray(vao));
+	vb.Bind();
+	ib.Bind(); // Recorded in the VAO
+
+	const auto& elements = layout.GetElements();
+	unsigned int offset = 0;
+	for (unsigned int i = 0; i < elements.size(); i++) {
+		const auto& element = elements[i];
+		GLCall(glEnableVertexAttribArray(i));
+		if (element.integer) {
+			GLCall(glVertexAttribIPointer(i, element.count, element.type, layout.GetStride(), (const void*)(size_t)offset));
+		}
+		else {
+			GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)(size_t)offset));
+		}
+		offset += element.GetSize();
+	}
+	return vao;
+}
+
+void VertexArrayCache::Evict(unsigned int bufferID) {
+	if (m_UseAttribBinding) {
+		return; // Shared VAOs never hold on to a particular buffer
+	}
+
+	for (auto it = m_VertexArrays.begin(); it != m_VertexArrays.end();) {
+		if (it->first.vertexBufferID == bufferID || it->first.indexBufferID == bufferID) {
+			GLCall(glDeleteVertexArrays(1, &it->second));
+			it = m_VertexArrays.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+
+void VertexArrayCache::Clear() {
+	for (auto& entry : m_VertexArrays) {
+		GLCall(glDeleteVertexArrays(1, &entry.second));
+	}
+	m_VertexArrays.clear();
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+
+class VertexBuffer;
+class IndexBuffer;
+
+// Hands out VAOs so meshes sharing a layout don't each build their own.
+// With vertex attribute binding (GL 4.3 / ARB_vertex_attrib_binding) there is one VAO per
+// layout: the attribute formats are recorded once and the vertex buffer is swapped in with
+// glBindVertexBuffer. Without it the cache falls back to one VAO per (buffers, layout) set,
+// which still skips the attribute setup for combinations already seen.
+class VertexArrayCache {
+private:
+	struct Key {
+		unsigned long long layoutHash; // Picks the bucket, equal layouts are then told apart by their elements
+		std::vector<VertexBufferElement> elements;
+		unsigned int stride;
+		unsigned int vertexBufferID; // 0 when using attribute binding
+		unsigned int indexBufferID; // 0 when using attribute binding
+
+		inline bool operator==(const Key& other) const {
+			return layoutHash == other.layoutHash && vertexBufferID == other.vertexBufferID && indexBufferID == other.indexBufferID
+				&& stride == other.stride && elements == other.elements;
+		}
+	};
+
+	struct KeyHash {
+		inline size_t operator()(const Key& key) const {
+			return (size_t)(key.layoutHash ^ (((unsigned long long)key.vertexBufferID << 32 | key.indexBufferID) * 0x9E3779B97F4A7C15ull));
+		}
+	};
+
+	std::unordered_map<Key, unsigned int, KeyHash> m_VertexArrays; // Key -> VAO
+	Key m_Lookup; // Reused by Bind, its elements keep their capacity so lookups don't allocate
+	bool m_UseAttribBinding;
+	unsigned int m_Hits;
+	unsigned int m_Misses;
+public:
+	VertexArrayCache();
+	~VertexArrayCache();
+
+	VertexArrayCache(const VertexArrayCache&) = delete;
+	VertexArrayCache& operator=(const VertexArrayCache&) = delete;
+
+	// Binds a VAO that reads layout from vb with ib as its element buffer, building it the first time
+	void Bind(const VertexBuffer& vb, const IndexBuffer& ib, const VertexBufferLayout& layout);
+
+	// Drops VAOs that reference the buffer, call before deleting it in fallback mode since GL reuses buffer names
+	void Evict(unsigned int bufferID);
+	void Clear();
+
+	inline bool UsesAttribBinding() const { return m_UseAttribBinding; }
+	inline unsigned int GetVertexArrayCount() const { return (unsigned int)m_VertexArrays.size(); }
+	inline unsigned int GetHits() const { return m_Hits; }
+	inline unsigned int GetMisses() const { return m_Misses; }
+private:
+	unsigned int CreateFormatVertexArray(const VertexBufferLayout& layout); // Formats only, no buffer attached
+	unsigned int CreateBoundVertexArray(const VertexBuffer& vb, const IndexBuffer& ib, const VertexBufferLayout& layout);
+};
\ No newline at end of file
@@ -1,11 +1,49 @@
 #include "VertexBuffer.h"
 #include "../Renderer.h"
 
+#include <algorithm>
+#include <cstring>
+
+unsigned int GetUsageHint(BufferUsage usage) {
+	switch (usage) {
+		case BufferUsage::Static:  return GL_STATIC_DRAW;
+		case BufferUsage::Dynamic: return GL_DYNAMIC_DRAW;
+		case BufferUsage::Stream:  return GL_STREAM_DRAW;
+	}
+	ASSERT(false);
+	return GL_STATIC_DRAW; // Should never reach here
+}
+
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+	: m_Size(size), m_Usage(BufferUsage::Static), m_WriteOffset(0)
+{
+	Create(data); // Upload the vertex data to the buffer
+}
+
+VertexBuffer::VertexBuffer(unsigned int size, BufferUsage usage)
+	: m_Size(size), m_Usage(usage), m_WriteOffset(0)
+{
+	Create(nullptr); // Allocate storage, contents come later
+}
+
+void VertexBuffer::Create(const void* data)
 {
+	if (GLHasDirectStateAccess()) {
+		GLCall(glCreateBuffers(1, &m_RendererID)); // Create the buffer without touching any binding
+		if (m_Usage == BufferUsage::Static) {
+			// Immutable storage for data that never gets orphaned, sub-range updates stay allowed.
+			// A zero size is GL_INVALID_VALUE here, so an empty buffer gets one uninitialized byte.
+			GLCall(glNamedBufferStorage(m_RendererID, std::max(m_Size, 1u), m_Size ? data : nullptr, GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT));
+		}
+		else {
+			GLCall(glNamedBufferData(m_RendererID, m_Size, data, GetUsageHint(m_Usage))); // Mutable, so Orphan can respecify it
+		}
+		return;
+	}
+
 	GLCall(glGenBuffers(1, &m_RendererID)); // Generate a buffer ID
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID)); // Bind the buffer to the GL_ARRAY_BUFFER target
-	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW)); // Upload the vertex data to the buffer
+	GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, data, GetUsageHint(m_Usage)));
 }
 
 VertexBuffer::~VertexBuffer()
@@ -13,6 +51,25 @@ VertexBuffer::~VertexBuffer()
 	GLCall(glDeleteBuffers(1, &m_RendererID)); // Delete the buffer
 }
 
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Size(other.m_Size), m_Usage(other.m_Usage), m_WriteOffset(other.m_WriteOffset)
+{
+	other.m_RendererID = 0; // The moved-from buffer deletes nothing
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+	if (this != &other) {
+		GLCall(glDeleteBuffers(1, &m_RendererID)); // Release the buffer we are replacing
+		m_RendererID = other.m_RendererID;
+		m_Size = other.m_Size;
+		m_Usage = other.m_Usage;
+		m_WriteOffset = other.m_WriteOffset;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
 void VertexBuffer::Bind() const
 {
 	// Bind the vertex buffer to the GL_ARRAY_BUFFER target
@@ -23,4 +80,76 @@ void VertexBuffer::Unbind() const
 {
 	// Unbind the vertex buffer by binding 0 to the GL_ARRAY_BUFFER target
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+void VertexBuffer::SetData(unsigned int offset, const void* data, unsigned int size)
+{
+	ASSERT(offset + size <= m_Size);
+	if (GLHasDirectStateAccess()) {
+		GLCall(glNamedBufferSubData(m_RendererID, offset, size, data)); // Update the sub-range in place
+		return;
+	}
+	Bind();
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data)); // Update the sub-range in place
+}
+
+void VertexBuffer::Orphan()
+{
+	// Respecifying the storage with no data lets the driver hand us fresh memory while draws still read the old one
+	if (GLHasDirectStateAccess()) {
+		if (m_Usage == BufferUsage::Static) {
+			GLCall(glInvalidateBufferData(m_RendererID)); // Immutable storage can't be respecified, invalidating has the same effect
+		}
+		else {
+			GLCall(glNamedBufferData(m_RendererID, m_Size, nullptr, GetUsageHint(m_Usage)));
+		}
+	}
+	else {
+		Bind();
+		GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GetUsageHint(m_Usage)));
+	}
+	m_WriteOffset = 0;
+}
+
+void* VertexBuffer::Map(unsigned int offset, unsigned int size)
+{
+	ASSERT(offset + size <= m_Size);
+	const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+	if (GLHasDirectStateAccess()) {
+		GLCall(void* ptr = glMapNamedBufferRange(m_RendererID, offset, size, access));
+		return ptr;
+	}
+	Bind();
+	GLCall(void* ptr = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, access));
+	return ptr;
+}
+
+void VertexBuffer::Unmap()
+{
+	if (GLHasDirectStateAccess()) {
+		GLCall(glUnmapNamedBuffer(m_RendererID));
+		return;
+	}
+	Bind();
+	GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+}
+
+unsigned int VertexBuffer::Append(const void* data, unsigned int size)
+{
+	ASSERT(size <= m_Size);
+	if (m_WriteOffset + size > m_Size) {
+		Orphan(); // Out of room, start over on fresh storage instead of overwriting data the GPU may still read
+	}
+
+	// The range past the cursor has never been handed to a draw since the last orphan, so no sync is needed
+	unsigned int offset = m_WriteOffset;
+	void* ptr = Map(offset, size);
+	if (!ptr) {
+		return INVALID_OFFSET; // Nothing is mapped, so there is nothing to unmap either
+	}
+	memcpy(ptr, data, size);
+	Unmap();
+
+	m_WriteOffset += size;
+	return offset;
 }
\ No newline at end of file
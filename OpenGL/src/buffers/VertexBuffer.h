@@ -1,12 +1,50 @@
 #pragma once
 
+// How often the buffer contents change, maps to the GL usage hint
+enum class BufferUsage {
+	Static, // Uploaded once, drawn many times (GL_STATIC_DRAW)
+	Dynamic, // Updated now and then, drawn many times (GL_DYNAMIC_DRAW)
+	Stream // Rewritten every frame (GL_STREAM_DRAW)
+};
+
+unsigned int GetUsageHint(BufferUsage usage); // GL_STATIC_DRAW, GL_DYNAMIC_DRAW or GL_STREAM_DRAW
+
 class VertexBuffer {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Size; // Size of the buffer storage in bytes
+	BufferUsage m_Usage;
+	unsigned int m_WriteOffset; // Stream cursor used by Append
 public:
 	VertexBuffer(const void* data, unsigned int size);// Constructor to create a vertex buffer with given data and size
+	VertexBuffer(unsigned int size, BufferUsage usage);// Constructor to allocate an empty buffer for dynamic or streamed data
 	~VertexBuffer();// Destructor to clean up the vertex buffer
 
+	// GL names are owned, so the buffer can move but never be copied
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
+
+	void SetData(unsigned int offset, const void* data, unsigned int size); // Updates a sub-range with glBufferSubData
+	void Orphan(); // Detaches the current storage so in-flight draws keep the old copy and writes never wait on them
+
+	// Maps [offset, offset + size) for writing without waiting on the GPU, the caller must not touch data still in use
+	void* Map(unsigned int offset, unsigned int size);
+	void Unmap();
+
+	// Writes data after the previous Append and returns its byte offset, orphaning the buffer when it runs out of space.
+	// Returns INVALID_OFFSET and leaves the cursor alone if the range could not be mapped.
+	unsigned int Append(const void* data, unsigned int size);
+
+	static const unsigned int INVALID_OFFSET = 0xFFFFFFFF;
+
+	inline unsigned int GetSize() const { return m_Size; }
+	inline BufferUsage GetUsage() const { return m_Usage; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+private:
+	void Create(const void* data);
 };
\ No newline at end of file
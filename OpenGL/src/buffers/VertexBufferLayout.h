@@ -1,25 +1,49 @@
 #pragma once
 
 #include <vector>
+#include <type_traits>
 #include <GL/glew.h>
 
 #include "../Renderer.h"
 
+// Tag types for vertex formats that have no matching C++ type
+struct Half { unsigned short bits; }; // GL_HALF_FLOAT, see glm::packHalf1x16
+struct Packed1010102 { unsigned int bits; }; // GL_INT_2_10_10_10_REV, signed normalized xyz + w, see glm::packSnorm3x10_1x2
+
 struct VertexBufferElement {
 	unsigned int type; // Data type (e.g., GL_FLOAT)
 	unsigned int count; // Number of elements
 	unsigned char normalized; // Whether the data should be normalized
+	unsigned char integer; // Whether the shader reads it as an int/uint attribute (glVertexAttribIPointer)
 
 	static unsigned int GetSizeOfType(unsigned int type) {
 		switch (type) {
-			case GL_FLOAT:         return sizeof(float);
-			case GL_UNSIGNED_INT:  return sizeof(unsigned int);
-			case GL_UNSIGNED_BYTE: return sizeof(unsigned char);
-			default:               return 0; // Unsupported type
+			case GL_FLOAT:                        return sizeof(float);
+			case GL_UNSIGNED_INT:                 return sizeof(unsigned int);
+			case GL_INT:                          return sizeof(int);
+			case GL_HALF_FLOAT:                   return sizeof(unsigned short);
+			case GL_UNSIGNED_SHORT:               return sizeof(unsigned short);
+			case GL_SHORT:                        return sizeof(short);
+			case GL_UNSIGNED_BYTE:                return sizeof(unsigned char);
+			case GL_BYTE:                         return sizeof(signed char);
+			case GL_INT_2_10_10_10_REV:           return sizeof(unsigned int); // All four components share one word
+			case GL_UNSIGNED_INT_2_10_10_10_REV:  return sizeof(unsigned int);
+			default:                              return 0; // Unsupported type
 		}
 		ASSERT(false);
 		return 0; // Should never reach here
 	}
+
+	static bool IsPacked(unsigned int type) {
+		return type == GL_INT_2_10_10_10_REV || type == GL_UNSIGNED_INT_2_10_10_10_REV;
+	}
+
+	// Size of the whole attribute in bytes, packed formats store every component in a single word
+	inline unsigned int GetSize() const { return IsPacked(type) ? GetSizeOfType(type) : count * GetSizeOfType(type); }
+
+	inline bool operator==(const VertexBufferElement& other) const {
+		return type == other.type && count == other.count && normalized == other.normalized && integer == other.integer;
+	}
 };
 
 class VertexBufferLayout {
@@ -30,30 +54,114 @@ public:
 	VertexBufferLayout()
 		: m_Stride(0) {}
 
+    // Float attributes. Integer C++ types are converted to float by GL,
+    // normalized to [0, 1] / [-1, 1] for chars and shorts
     template<typename T>
     void Push(unsigned int count) {
         static_assert(std::is_same<T, void>::value, "Unsupported type");
     }
 
-    // Explicit specializations (now inside class, compiler-specific)
-    template<>
-    void Push<float>(unsigned int count) {
-        m_Elements.push_back({ GL_FLOAT, count, GL_FALSE });
-        m_Stride += count * VertexBufferElement::GetSizeOfType(GL_FLOAT);
-    }
-
-    template<>
-    void Push<unsigned int>(unsigned int count) {
-        m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
-        m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT);
+    // Integer attributes, read in the shader as int/ivecN or uint/uvecN
+    template<typename T>
+    void PushInteger(unsigned int count) {
+        static_assert(std::is_same<T, void>::value, "Unsupported type");
     }
 
-    template<>
-    void Push<unsigned char>(unsigned int count) {
-        m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-        m_Stride += count * VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE);
-    }
+	// Adds an element with an explicit GL type, for formats chosen at runtime (e.g. by the vertex quantizer)
+	void Push(unsigned int type, unsigned int count, bool normalized, bool integer = false) {
+		ASSERT(VertexBufferElement::GetSizeOfType(type) != 0);
+		ASSERT(!VertexBufferElement::IsPacked(type) || count == 4);
+		VertexBufferElement element = { type, count, (unsigned char)(normalized ? GL_TRUE : GL_FALSE), (unsigned char)(integer ? GL_TRUE : GL_FALSE) };
+		m_Elements.push_back(element);
+		m_Stride += element.GetSize();
+	}
 
 	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
     inline unsigned int GetStride() const { return m_Stride; }
-};
\ No newline at end of file
+
+	// FNV-1a over every element and the stride, equal layouts hash equal
+	unsigned long long GetHash() const {
+		unsigned long long hash = 14695981039346656037ull;
+		auto mix = [&hash](unsigned int value) {
+			for (int i = 0; i < 4; i++) {
+				hash ^= (value >> (i * 8)) & 0xFF;
+				hash *= 1099511628211ull;
+			}
+		};
+		for (const VertexBufferElement& element : m_Elements) {
+			mix(element.type);
+			mix(element.count);
+			mix(element.normalized | (element.integer << 8));
+		}
+		mix(m_Stride);
+		return hash;
+	}
+};
+
+// Explicit specializations live at namespace scope so every compiler accepts them
+
+template<>
+inline void VertexBufferLayout::Push<float>(unsigned int count) {
+    Push(GL_FLOAT, count, false);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned int>(unsigned int count) {
+    Push(GL_UNSIGNED_INT, count, false);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned char>(unsigned int count) {
+    Push(GL_UNSIGNED_BYTE, count, true);
+}
+
+template<>
+inline void VertexBufferLayout::Push<signed char>(unsigned int count) {
+    Push(GL_BYTE, count, true);
+}
+
+template<>
+inline void VertexBufferLayout::Push<unsigned short>(unsigned int count) {
+    Push(GL_UNSIGNED_SHORT, count, true);
+}
+
+template<>
+inline void VertexBufferLayout::Push<short>(unsigned int count) {
+    Push(GL_SHORT, count, true);
+}
+
+template<>
+inline void VertexBufferLayout::Push<Half>(unsigned int count) {
+    Push(GL_HALF_FLOAT, count, false);
+}
+
+template<>
+inline void VertexBufferLayout::Push<Packed1010102>(unsigned int count) {
+    ASSERT(count == 4); // One packed word always carries xyz + w
+    Push(GL_INT_2_10_10_10_REV, 4, true);
+}
+
+template<>
+inline void VertexBufferLayout::PushInteger<int>(unsigned int count) {
+    Push(GL_INT, count, false, true);
+}
+
+template<>
+inline void VertexBufferLayout::PushInteger<unsigned int>(unsigned int count) {
+    Push(GL_UNSIGNED_INT, count, false, true);
+}
+
+template<>
+inline void VertexBufferLayout::PushInteger<short>(unsigned int count) {
+    Push(GL_SHORT, count, false, true);
+}
+
+template<>
+inline void VertexBufferLayout::PushInteger<unsigned short>(unsigned int count) {
+    Push(GL_UNSIGNED_SHORT, count, false, true);
+}
+
+template<>
+inline void VertexBufferLayout::PushInteger<unsigned char>(unsigned int count) {
+    Push(GL_UNSIGNED_BYTE, count, false, true);
+}
\ No newline at end of file
@@ -6,15 +6,40 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 
 #include "Renderer.h" // Include the Renderer header for GLCall macro
 
 #include "buffers/VertexBuffer.h"
 #include "buffers/VertexBufferLayout.h"
+#include "buffers/StaticVertexLayout.h"
 #include "buffers/IndexBuffer.h"
 #include "buffers/VertexArray.h"
+#include "buffers/VertexArrayCache.h"
+#include "buffers/MeshArena.h"
+#include "buffers/RingBuffer.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "RenderQueue.h"
+#include "ResourcePool.h"
+#include "RenderTargetPool.h"
+#include "RenderGraph.h"
+#include "PostProcessChain.h"
+#include "DynamicResolution.h"
+#include "assets/AssetPack.h"
+#include "mesh/MeshLoadBenchmark.h"
+#include "mesh/MeshLod.h"
+#include "scene/SceneGraph.h"
+#include "scene/SpriteGrid.h"
+#include "scene/TransformBenchmark.h"
+#include "scene/TransformSystem.h"
+#include "scene/FrustumCuller.h"
+#include "scene/Bvh.h"
+#include "scene/OcclusionCuller.h"
+#include "scene/GpuCuller.h"
 #include "tests/TestClearColor.h"
 
 #include "glm/glm.hpp" // Include GLM for vector and matrix operations
@@ -27,21 +52,109 @@
 const float WINDW_SIZE_X = 960.0f; // Define the window width
 const float WINDW_SIZE_Y = 540.0f; // Define the window height
 
-int main(void)
+struct QuadVertex {
+    glm::vec2 position;
+    glm::vec2 texCoord;
+};
+
+constexpr auto QUAD_LAYOUT = MakeVertexLayout<QuadVertex>(
+    VERTEX_ATTRIBUTE(QuadVertex, position),
+    VERTEX_ATTRIBUTE(QuadVertex, texCoord));
+static_assert(QUAD_LAYOUT.stride == 4 * sizeof(float), "QuadVertex must stay tightly packed");
+
+struct DiscVertex {
+    glm::vec3 position;
+    glm::vec2 texCoord;
+};
+
+constexpr auto DISC_LAYOUT = MakeVertexLayout<DiscVertex>(
+    VERTEX_ATTRIBUTE(DiscVertex, position),
+    VERTEX_ATTRIBUTE(DiscVertex, texCoord));
+
+const unsigned int DISC_RINGS = 24;
+const unsigned int DISC_SEGMENTS = 64;
+const float DISC_DOME_HEIGHT = 0.4f; // Relief in z, which is what the LOD levels flatten, the field stays inside the depth range
+
+// Unit disc domed towards the camera, dense enough that its LOD chain has levels to pick from
+static void BuildDisc(std::vector<DiscVertex>& vertices, std::vector<unsigned int>& indices) {
+    vertices.push_back({ { 0.0f, 0.0f, DISC_DOME_HEIGHT }, { 0.5f, 0.5f } });
+    for (unsigned int ring = 1; ring <= DISC_RINGS; ring++) {
+        const float radius = (float)ring / DISC_RINGS;
+        for (unsigned int segment = 0; segment < DISC_SEGMENTS; segment++) {
+            const float angle = 6.2831853f * segment / DISC_SEGMENTS;
+            const glm::vec2 position(radius * std::cos(angle), radius * std::sin(angle));
+            vertices.push_back({ glm::vec3(position, DISC_DOME_HEIGHT * (1.0f - radius * radius)), position * 0.5f + 0.5f });
+        }
+    }
+    for (unsigned int ring = 0; ring < DISC_RINGS; ring++) {
+        const unsigned int inner = ring == 0 ? 0 : 1 + (ring - 1) * DISC_SEGMENTS;
+        const unsigned int outer = 1 + ring * DISC_SEGMENTS;
+        for (unsigned int segment = 0; segment < DISC_SEGMENTS; segment++) {
+            const unsigned int next = (segment + 1) % DISC_SEGMENTS;
+            if (ring == 0) {
+                indices.insert(indices.end(), { 0, outer + segment, outer + next });
+                continue;
+            }
+            indices.insert(indices.end(), { inner + segment, outer + segment, outer + next });
+            indices.insert(indices.end(), { inner + segment, outer + next, inner + next });
+        }
+    }
+}
+
+// How the disc field is culled, picked in the overlay
+enum class CullingMode {
+    Frustum,
+    Occlusion, // Frustum, then hardware occlusion queries against the quads in front
+    Instanced, // No culling, TransformSystem writes every MVP into an instance buffer for one draw
+    Gpu // Compute shader and one multi-draw indirect, GL 4.3 only
+};
+const char* CULLING_MODE_NAMES[] = { "Frustum", "Frustum + occlusion", "None (one instanced draw)", "GPU (compute + multi-draw indirect)" };
+
+const unsigned int FIELD_COLUMNS = 16; // The field runs past the right edge of the window, so some of it is culled
+const unsigned int FIELD_ROWS = 6;
+
+const char* ASSET_PACK_PATH = "res/assets.pack"; // Cooked assets, loose files under res/ are used when it is missing
+
+int main(int argc, char** argv)
 {
+    // "OpenGL --pack <files...>" cooks the listed assets into the pack and exits
+    if (argc > 2 && std::string(argv[1]) == "--pack") {
+        std::vector<std::string> files(argv + 2, argv + argc);
+        return AssetPack::Build(ASSET_PACK_PATH, files) ? 0 : -1;
+    }
+
+    // "OpenGL --bench-transforms" times the transform kernels for 10k to 1M objects and exits
+    if (argc > 1 && std::string(argv[1]) == "--bench-transforms") {
+        RunTransformBenchmark();
+        return 0;
+    }
+
+    // "OpenGL --bench-mesh" times LoadObj on a generated 1M-triangle OBJ and exits
+    if (argc > 1 && std::string(argv[1]) == "--bench-mesh") {
+        RunMeshLoadBenchmark();
+        return 0;
+    }
+
     GLFWwindow* window;
 
     /* Initialize the library */
     if (!glfwInit())
         return -1;
 
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); // Set the major version of OpenGL
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // Set the minor version of OpenGL
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4); // 4.3 for GPU culling (compute shaders, multi-draw indirect)
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // Use the core profile of OpenGL
 
     /* Create a windowed mode window and its OpenGL context */
     window = glfwCreateWindow((int)WINDW_SIZE_X, (int)WINDW_SIZE_Y, "Hello World", NULL, NULL);
     if (!window)
+    {
+        // Everything else runs on 3.3 (macOS stops at 4.1), the disc field is then culled on the CPU only
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow((int)WINDW_SIZE_X, (int)WINDW_SIZE_Y, "Hello World", NULL, NULL);
+    }
+    if (!window)
     {
         glfwTerminate();
         return -1;
@@ -60,11 +173,11 @@ int main(void)
 	std::cout << glGetString(GL_VERSION) << std::endl;
     {
 
-        float positions[] = {
-            -50.0f, -50.0f, 0.0f, 0.0f, // Bottom left
-             50.0f, -50.0f, 1.0f, 0.0f, // Bottom right
-             50.0f,  50.0f, 1.0f, 1.0f,  // Top right
-            -50.0f,  50.0f, 0.0f, 1.0f // Top left
+        QuadVertex positions[] = {
+            { { -50.0f, -50.0f }, { 0.0f, 0.0f } }, // Bottom left
+            { {  50.0f, -50.0f }, { 1.0f, 0.0f } }, // Bottom right
+            { {  50.0f,  50.0f }, { 1.0f, 1.0f } },  // Top right
+            { { -50.0f,  50.0f }, { 0.0f, 1.0f } } // Top left
         };
 
         unsigned int indices[] = {
@@ -72,18 +185,13 @@ int main(void)
             2, 3, 0
         };
 
-		GLCall(glEnable(GL_BLEND)); // Enable blending for transparency
-		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)); // Set the blending function for transparency
-
-		VertexArray va; // Create a Vertex Array Object (VAO) to hold the vertex attributes
         VertexBuffer vb(positions, sizeof(positions)); // Create a Vertex Buffer Object (VBO) with the vertex data
 
-        VertexBufferLayout layout;
-		layout.Push<float>(2); 
-        layout.Push<float>(2);
-		va.AddBuffer(vb, layout);
+        // Layout built at compile time from QuadVertex, the VAO comes from the cache
+        const VertexBufferLayout quadLayout = ToVertexBufferLayout(QUAD_LAYOUT);
+        VertexArrayCache vertexArrays; // One VAO per layout with attribute binding, per buffer set without
 
-        IndexBuffer ib(indices, sizeof(indices)); // Create an Index Buffer Object (IBO) with the index data
+        IndexBuffer ib(indices, sizeof(indices) / sizeof(indices[0])); // Create an Index Buffer Object (IBO) with the index data, stored as 16-bit
 
         glm::mat4 proj = glm::ortho(0.0f, WINDW_SIZE_X, 0.0f, WINDW_SIZE_Y, -1.0f, 1.0f);
         glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f));
@@ -91,20 +199,34 @@ int main(void)
         glm::vec4 vp(100.0f, 100.0f, 0.0f, 1.0f);
 
         
-        // Parse the shader file
-		Shader shader("res/shaders/Basic.shader"); // Create a Shader object with the shader file path
-		shader.Bind(); // Bind the shader program
+		AssetPack pack(ASSET_PACK_PATH); // Map the asset pack once for every resource below
+
+        // Every shader lives in one pool, draws look them up by handle and they are released together
+        ResourcePool<Shader> shaders;
+		const Handle<Shader> basicShader = shaders.Create(pack, "res/shaders/Basic.shader"); // Parse the shader file
+		shaders.Get(basicShader)->Bind(); // Bind the shader program
 
-        Texture texture("res/textures/texture1.png");
-		texture.Bind(); // Bind the texture 
-		shader.SetUniform1i("u_Texture", 0); // Set the texture uniform in the shader
+        Texture texture(pack, "res/textures/texture1.png");
+		shaders.Get(basicShader)->SetUniform1i("u_Texture", 0); // Set the texture uniform in the shader
 
-		va.Unbind(); // Unbind the VAO
-		shader.Unbind(); // Unbind the shader program
+		shaders.Get(basicShader)->Unbind(); // Unbind the shader program
 		vb.Unbind(); // Unbind the VBO
 		ib.Unbind(); // Unbind the IBO
 
 		Renderer renderer; // Create a Renderer object to handle OpenGL calls
+		RenderQueue queue(pack); // Sets depth and blend state per pass, blending is no longer global
+		RenderTargetPool targets; // Offscreen targets, reused every frame while the window size holds
+		RenderGraph graph(targets); // Rebuilt every frame, keeps the pass timings
+
+		// Per-pixel effects share one generated pass, FXAA reads neighbors and gets a second one
+		PostProcessChain post;
+		const unsigned int toneMapEffect = post.AddEffect(PostProcessChain::ToneMap());
+		post.AddEffect(PostProcessChain::ColorGrade(1.1f, 1.1f));
+		post.AddEffect(PostProcessChain::Vignette());
+		post.AddEffect(PostProcessChain::Fxaa());
+		post.SetEnabled(toneMapEffect, false); // The scene is LDR for now
+
+		DynamicResolution resolution(pack); // Holds 60 Hz by lowering the scene's resolution
 
 		// Setting up ImGui
 		IMGUI_CHECKVERSION(); // Check ImGui version
@@ -119,6 +241,96 @@ int main(void)
 
         glm::vec3 translationA(200.0f, 200.0f, 0.0f);
         glm::vec3 translationB(400.0f, 200.0f, 0.0f);
+        glm::vec3* translations[] = { &translationA, &translationB };
+
+        // The quads are scene graph nodes, a slider edit queues its node and Update recomputes only that one
+        SceneGraph quadScene;
+        std::vector<SceneNode> quadNodes;
+        for (glm::vec3* translation : translations) {
+            quadNodes.push_back(quadScene.CreateNode({ SceneGraph::INVALID_ID }, *translation));
+        }
+
+        const glm::vec3 quadMin(-50.0f, -50.0f, 0.0f); // Bounds of the quad vertices
+        const glm::vec3 quadMax(50.0f, 50.0f, 0.0f);
+        SpriteGrid quadGrid; // Inserted in order into an empty grid, so sprite ids are the indices into translations
+        for (glm::vec3* translation : translations) {
+            quadGrid.Insert(glm::vec2(*translation), glm::vec2(quadMax));
+        }
+        std::vector<unsigned int> visible;
+
+        // A field of discs of many sizes behind the quads, all sharing one mesh and its LOD chain
+        // in an arena. Each instance is drawn at the level its size on screen needs.
+        std::vector<DiscVertex> discVertices;
+        std::vector<unsigned int> discIndices;
+        BuildDisc(discVertices, discIndices);
+        const MeshLodChain discLods = BuildLodChain(discIndices.data(), (unsigned int)discIndices.size(),
+            &discVertices[0].position.x, sizeof(DiscVertex), (unsigned int)discVertices.size());
+        MeshArena fieldArena(ToVertexBufferLayout(DISC_LAYOUT), (unsigned int)discVertices.size(), (unsigned int)discLods.indices.size());
+        const MeshHandle discMesh = fieldArena.Add(discVertices.data(), (unsigned int)discVertices.size(),
+            discLods.indices.data(), (unsigned int)discLods.indices.size());
+        std::vector<glm::mat4> fieldModels;
+        FrustumCuller fieldCuller; // Same index as fieldModels
+        OcclusionCuller occlusion(pack); // Same index again
+        TransformSystem fieldTransforms; // And again, for the instanced mode
+        CullingMode cullingMode = CullingMode::Frustum;
+        for (unsigned int i = 0; i < FIELD_COLUMNS * FIELD_ROWS; i++) {
+            const float radius = 6.0f + 34.0f * ((i * 7) % 10) / 9.0f;
+            const glm::vec3 position(40.0f + (i % FIELD_COLUMNS) * 90.0f, 45.0f + (i / FIELD_COLUMNS) * 90.0f, -0.5f); // Behind the quads
+            fieldModels.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(radius, radius, 1.0f)));
+            fieldCuller.AddBox(position - glm::vec3(radius, radius, 0.0f), position + glm::vec3(radius, radius, DISC_DOME_HEIGHT));
+            occlusion.Add(position - glm::vec3(radius, radius, 0.0f), position + glm::vec3(radius, radius, DISC_DOME_HEIGHT));
+            fieldTransforms.Add(position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(radius, radius, 1.0f));
+        }
+        std::vector<unsigned int> fieldVisible;
+
+        // The instanced mode draws level 0 of the disc for every instance, the MVPs are computed
+        // by the transform kernels and written straight into a streamed instance buffer
+        VertexBuffer discVb(discVertices.data(), (unsigned int)(discVertices.size() * sizeof(DiscVertex)));
+        IndexBuffer discIb(discLods.indices.data() + discLods.levels[0].firstIndex, discLods.levels[0].indexCount);
+        VertexBuffer fieldInstances(fieldTransforms.GetCount() * (unsigned int)sizeof(glm::mat4), BufferUsage::Stream);
+        VertexBufferLayout instanceLayout;
+        for (unsigned int column = 0; column < 4; column++) {
+            instanceLayout.Push<float>(4); // A mat4 takes one attribute per column
+        }
+        // With persistent mapping, and base instances to pick the frame's region, the instances stream
+        // through a fenced ring instead and writing them costs no GL call
+        std::unique_ptr<RingBuffer> instanceRing;
+        if (RingBuffer::IsSupported() && (GLEW_VERSION_4_2 || GLEW_ARB_base_instance)) {
+            instanceRing.reset(new RingBuffer(fieldInstances.GetSize()));
+        }
+        VertexArray fieldInstanced;
+        fieldInstanced.AddBuffer(discVb, DISC_LAYOUT);
+        if (instanceRing) {
+            fieldInstanced.AddInstanceBuffer(*instanceRing, instanceLayout, 2); // i_MVP in Instanced.shader
+        }
+        else {
+            fieldInstanced.AddInstanceBuffer(fieldInstances, instanceLayout, 2);
+        }
+        fieldInstanced.SetIndexBuffer(discIb);
+        const Handle<Shader> instancedShader = shaders.Create(pack, "res/shaders/Instanced.shader");
+
+        // The same field culled and submitted on the GPU, when the context has 4.3. Every disc draws
+        // level 0 of the chain, the culling pass has no LOD selection.
+        std::unique_ptr<GpuCuller> gpuCuller;
+        Handle<Shader> indirectShader; // Stays invalid without 4.3
+        std::string gpuValidation = "not run";
+        bool validateGpuCulling = false; // Set when the mode is picked, runs on the first GPU-culled frame
+        if (GpuCuller::IsSupported()) {
+            gpuCuller.reset(new GpuCuller(pack, fieldArena, (unsigned int)fieldModels.size()));
+            indirectShader = shaders.Create(pack, "res/shaders/Indirect.shader");
+            for (const glm::mat4& model : fieldModels) {
+                gpuCuller->Add(discMesh, discLods.levels[0], model, discLods.center, discLods.radius);
+            }
+        }
+
+        // Same boxes in a BVH for picking under the cursor, refit as the sliders move them
+        std::vector<glm::vec3> quadMins, quadMaxs;
+        for (glm::vec3* translation : translations) {
+            quadMins.push_back(*translation + quadMin);
+            quadMaxs.push_back(*translation + quadMax);
+        }
+        Bvh bvh;
+        bvh.Build(quadMins.data(), quadMaxs.data(), (unsigned int)quadMins.size());
 
         float r = 0.2f;
         float g = 0.1f;
@@ -128,33 +340,113 @@ int main(void)
         /* Loop until the user closes the window */
         while (!glfwWindowShouldClose(window))
         {
-            /* Render here */
-			renderer.Clear(); // Clear the screen
-
+			resolution.BeginFrame(); // GPU time from here to EndFrame drives the render scale
+            if (instanceRing) {
+                instanceRing->BeginFrame(); // Waits only if the GPU still reads the region from frames ago
+            }
 			test.OnUpdate(0.0f); // Update the test object
-            test.OnRender();
 
 			ImGui_ImplOpenGL3_NewFrame(); // Start a new ImGui frame
             ImGui_ImplGlfw_NewFrame();
 			ImGui::NewFrame(); // Create a new ImGui frame
 
 
-			shader.Bind(); // Bind the shader program
-            {
-                glm::mat4 model = glm::translate(glm::mat4(1.0f), translationA);
-                glm::mat4 mvp = proj * view * model;
-                shader.SetUniformMat4f("u_MVP", mvp);
-                // Draw the object using the Renderer
-                renderer.Draw(va, ib, shader);
+			// Only quads that overlap the view reach the renderer
+            quadScene.Update();
+            const glm::mat4* quadWorld = quadScene.GetWorldMatrices();
+            for (unsigned int i = 0; i < (unsigned int)quadNodes.size(); i++) {
+                const glm::vec3 position(quadWorld[quadScene.GetIndex(quadNodes[i])][3]);
+                quadGrid.Move(i, glm::vec2(position));
+                bvh.SetBounds(i, position + quadMin, position + quadMax);
+            }
+            bvh.Refit();
+            glm::vec2 viewMin, viewMax;
+            SpriteGrid::GetViewRect(proj * view, viewMin, viewMax);
+            visible.clear();
+            quadGrid.Query(viewMin, viewMax, visible);
+            fieldVisible.clear();
+            if (cullingMode == CullingMode::Frustum || cullingMode == CullingMode::Occlusion) {
+                fieldCuller.Cull(proj * view, fieldVisible);
+            }
+            if (cullingMode == CullingMode::Occlusion) {
+                // Orthographic, there is no near plane around the camera to clip the boxes
+                occlusion.BeginFrame(proj * view, glm::vec3(glm::inverse(view)[3]), 0.0f);
+                queue.SetOcclusionCuller(&occlusion);
+            }
+            else {
+                queue.SetOcclusionCuller(nullptr);
             }
 
-            {
-                glm::mat4 model = glm::translate(glm::mat4(1.0f), translationB);
-                glm::mat4 mvp = proj * view * model;
-                shader.SetUniformMat4f("u_MVP", mvp);
-                // Draw the object using the Renderer
-                renderer.Draw(va, ib, shader);
+            // The scene goes to a transient 4x MSAA target at the dynamic resolution, then is
+            // resolved, post-processed and upscaled into the window
+            int frameWidth, frameHeight;
+            glfwGetFramebufferSize(window, &frameWidth, &frameHeight);
+            frameWidth = std::max(frameWidth, 1); // Minimized windows report 0
+            frameHeight = std::max(frameHeight, 1);
+            FramebufferSpec sceneSpec;
+            resolution.GetRenderSize(frameWidth, frameHeight, sceneSpec.width, sceneSpec.height);
+            sceneSpec.samples = 4;
+
+            graph.Reset();
+            bool gpuCulled = false; // This frame's field went through gpuCuller
+            RenderGraphResource sceneTarget = graph.CreateTarget("Scene", sceneSpec);
+            RenderGraphResource windowTarget = graph.ImportWindow("Window", frameWidth, frameHeight);
+            graph.AddPass("Scene", [&](const Renderer&, const RenderGraph&) {
+                renderer.Clear(); // Clear the screen
+                test.OnRender();
+                texture.Bind(); // Every frame, ImGui binds its font texture to unit 0 after the scene
+                Shader& shader = *shaders.Get(basicShader);
+                for (unsigned int index : visible) {
+                    // The texture is fully opaque, the depth pre-pass covers the quads
+                    queue.Submit(vertexArrays, vb, ib, quadLayout, shader, quadWorld[quadScene.GetIndex(quadNodes[index])], RenderPass::Opaque);
+                }
+                for (unsigned int index : fieldVisible) {
+                    queue.Submit(fieldArena, discMesh, discLods, shader, fieldModels[index], RenderPass::Opaque, index);
+                }
+                queue.Execute(renderer, view, proj, (float)sceneSpec.height);
+                if (cullingMode == CullingMode::Instanced) {
+                    // Opaque as well, drawn after the queue like the GPU-culled field
+                    Shader& instanced = *shaders.Get(instancedShader);
+                    instanced.Bind();
+                    instanced.SetUniform1i("u_Texture", 0);
+                    if (instanceRing) {
+                        RingAllocation instances = fieldTransforms.WriteInstances(*instanceRing, proj * view);
+                        if (instances.IsValid()) {
+                            renderer.DrawInstanced(fieldInstanced, discIb, instanced, fieldTransforms.GetCount(), instances.offset / (unsigned int)sizeof(glm::mat4));
+                        }
+                    }
+                    else {
+                        fieldTransforms.WriteInstances(fieldInstances, proj * view);
+                        renderer.DrawInstanced(fieldInstanced, discIb, instanced, fieldTransforms.GetCount());
+                    }
+                }
+                if (cullingMode == CullingMode::Gpu) {
+                    // Opaque too, after the queue left depth testing and writes on
+                    gpuCuller->Cull(proj * view);
+                    Shader& indirect = *shaders.Get(indirectShader);
+                    indirect.Bind();
+                    indirect.SetUniformMat4f("u_ViewProjection", proj * view);
+                    indirect.SetUniform1i("u_Texture", 0);
+                    renderer.DrawIndirect(*gpuCuller, indirect);
+                    gpuCulled = true;
+                }
+            }).Write(sceneTarget);
+            FramebufferSpec postSpec = sceneSpec; // Single-sample color the post passes can sample
+            postSpec.depthFormat = 0;
+            postSpec.samples = 1;
+            RenderGraphResource resolvedTarget = graph.CreateTarget("Resolved", postSpec);
+            graph.AddPass("Resolve", [&](const Renderer&, const RenderGraph&) {
+                graph.GetTarget(sceneTarget)->Resolve(*graph.GetTarget(resolvedTarget));
+            }).Read(sceneTarget).Write(resolvedTarget);
+            if (sceneSpec.width == frameWidth && sceneSpec.height == frameHeight) {
+                post.AddPasses(graph, resolvedTarget, windowTarget, postSpec);
+            }
+            else {
+                RenderGraphResource postTarget = graph.CreateTarget("Post-processed", postSpec);
+                post.AddPasses(graph, resolvedTarget, postTarget, postSpec);
+                resolution.AddUpscalePass(graph, postTarget, windowTarget);
             }
+            graph.Execute(renderer); // The window stays bound, ImGui draws straight to it
 
 
             if (r >= 1.0f) {
@@ -168,9 +460,91 @@ int main(void)
             {
                 ImGui::Begin("Debug");
                 ImGui::Text("Hello, world!"); // Display text in the ImGui window
-                ImGui::SliderFloat3("translation a", &translationA.x, 0.0f, WINDW_SIZE_X);
-                ImGui::SliderFloat3("translation b", &translationB.x, 0.0f, WINDW_SIZE_X);
+                if (ImGui::SliderFloat3("translation a", &translationA.x, 0.0f, WINDW_SIZE_X)) {
+                    quadScene.SetLocalPosition(quadNodes[0], translationA);
+                }
+                if (ImGui::SliderFloat3("translation b", &translationB.x, 0.0f, WINDW_SIZE_X)) {
+                    quadScene.SetLocalPosition(quadNodes[1], translationB);
+                }
                 test.OnImGuiRender();
+                // The mouse is in window coordinates, which differ from framebuffer pixels on high-DPI displays
+                int windowWidth, windowHeight;
+                glfwGetWindowSize(window, &windowWidth, &windowHeight);
+                glm::vec3 rayOrigin, rayDirection;
+                GetPickRay(proj * view, glm::vec2(ImGui::GetMousePos().x, ImGui::GetMousePos().y),
+                    glm::vec2((float)std::max(windowWidth, 1), (float)std::max(windowHeight, 1)), rayOrigin, rayDirection);
+                BvhRayHit hit;
+                if (bvh.Raycast(rayOrigin, rayDirection, hit, 1.0f)) { // The direction spans the near to the far plane
+                    ImGui::Text("Under cursor: quad %u", hit.object);
+                }
+                else {
+                    ImGui::Text("Under cursor: nothing");
+                }
+                bool depthPrePass = queue.HasDepthPrePass();
+                if (ImGui::Checkbox("Depth pre-pass", &depthPrePass)) {
+                    queue.SetDepthPrePass(depthPrePass);
+                }
+                ImGui::Text("Quads: %u of %u in view, %u grid cells", (unsigned int)visible.size(), quadGrid.GetCount(), quadGrid.GetOccupiedCellCount());
+                int mode = (int)cullingMode;
+                const int modeCount = gpuCuller ? IM_ARRAYSIZE(CULLING_MODE_NAMES) : IM_ARRAYSIZE(CULLING_MODE_NAMES) - 1;
+                if (ImGui::Combo("Field culling", &mode, CULLING_MODE_NAMES, modeCount)) {
+                    validateGpuCulling = (CullingMode)mode == CullingMode::Gpu && cullingMode != CullingMode::Gpu;
+                    cullingMode = (CullingMode)mode;
+                }
+                if (!gpuCuller) {
+                    ImGui::Text("GPU culling needs GL 4.3, the context is %s", (const char*)glGetString(GL_VERSION));
+                }
+                if (cullingMode == CullingMode::Gpu) {
+                    // Reads the draws back and repeats the test on the CPU, stalls the frame
+                    if (ImGui::Button("Validate GPU culling") || (validateGpuCulling && gpuCulled)) {
+                        validateGpuCulling = false;
+                        unsigned int gpuVisible = 0;
+                        const unsigned int mismatches = gpuCuller->Validate(&gpuVisible);
+                        gpuValidation = std::to_string(gpuVisible) + " of " + std::to_string(gpuCuller->GetCount()) + " kept, "
+                            + (mismatches ? std::to_string(mismatches) + " disagree with the CPU" : "matches the CPU");
+                        std::cout << "GPU culling: " << gpuValidation << std::endl;
+                    }
+                    ImGui::Text("GPU culling: %s", gpuValidation.c_str());
+                }
+                else if (cullingMode == CullingMode::Instanced) {
+                    ImGui::Text("Field: %u discs in one instanced draw, MVPs from the %s kernel into %s", fieldTransforms.GetCount(), TransformSystem::GetKernelName(),
+                        instanceRing ? "a persistent ring" : "an orphaned buffer");
+                }
+                else {
+                    ImGui::Text("Field: %u visible, %u culled", fieldCuller.GetStats().visible, fieldCuller.GetStats().culled);
+                }
+                if (cullingMode == CullingMode::Occlusion) {
+                    ImGui::Text("Occlusion: %u occluded, %u queries", occlusion.GetStats().occluded, occlusion.GetStats().queries);
+                }
+                float maxPixelError = queue.GetMaxPixelError();
+                if (ImGui::SliderFloat("LOD pixel error", &maxPixelError, 0.1f, 8.0f)) {
+                    queue.SetMaxPixelError(maxPixelError);
+                }
+                std::string lodDraws = "LOD draws:";
+                for (unsigned int level = 0; level < discLods.levels.size(); level++) {
+                    lodDraws += " " + std::to_string(queue.GetLodDraws(level));
+                }
+                ImGui::Text("%s", lodDraws.c_str());
+                for (unsigned int i = 0; i < post.GetEffectCount(); i++) {
+                    bool enabled = post.GetEffect(i).enabled;
+                    if (ImGui::Checkbox(post.GetEffect(i).name.c_str(), &enabled)) {
+                        post.SetEnabled(i, enabled);
+                    }
+                }
+                ImGui::Text("Post-processing: %u full-screen passes", post.GetPassCount());
+                bool dynamicResolution = resolution.IsEnabled();
+                if (ImGui::Checkbox("Dynamic resolution", &dynamicResolution)) {
+                    resolution.SetEnabled(dynamicResolution);
+                }
+                float sharpness = resolution.GetSharpness();
+                if (ImGui::SliderFloat("Upscale sharpness", &sharpness, 0.0f, 1.0f)) {
+                    resolution.SetSharpness(sharpness);
+                }
+                ImGui::Text("GPU %.2f ms, rendering at %.0f%% (%dx%d)", resolution.GetGpuMilliseconds(), resolution.GetScale() * 100.0f, sceneSpec.width, sceneSpec.height);
+                ImGui::Text("Render graph: %u of %u passes, %u targets", graph.GetExecutedPassCount(), graph.GetPassCount(), graph.GetTargetCount());
+                if (ImGui::Button("Dump render graph")) {
+                    graph.Dump(std::cout);
+                }
 				ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
                 ImGui::End(); // End the ImGui window
@@ -178,12 +552,19 @@ int main(void)
 
 			ImGui::Render(); // Render ImGui
 			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData()); // Render ImGui draw data
+			resolution.EndFrame();
+			targets.EndFrame();
+            if (instanceRing) {
+                instanceRing->EndFrame(); // Fences the region after every draw that reads it
+            }
 
             /* Swap front and back buffers */
             glfwSwapBuffers(window);
             /* Poll for and process events */
             glfwPollEvents();
         }
+
+        shaders.Clear(); // Release every shader program at once, while the context is still current
     }
 
 	ImGui_ImplOpenGL3_Shutdown(); // Shutdown ImGui for OpenGL
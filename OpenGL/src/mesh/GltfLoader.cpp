@@ -0,0 +1,536 @@
+#include "MeshLoader.h"
+#include "VertexQuantizer.h"
+#include "../assets/MappedFile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+const uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+const uint32_t GLB_CHUNK_BIN = 0x004E4942; // "BIN\0"
+const int JSON_MAX_DEPTH = 64;
+
+// Just enough JSON for the glTF document, the binary data never goes through here
+struct JsonValue {
+	enum class Type { Null, Bool, Number, String, Array, Object };
+
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> elements; // Array
+	std::vector<std::pair<std::string, JsonValue>> members; // Object, in document order
+
+	// Returns nullptr if this is not an object or has no such member
+	const JsonValue* Find(const char* key) const {
+		for (const std::pair<std::string, JsonValue>& member : members) {
+			if (member.first == key) {
+				return &member.second;
+			}
+		}
+		return nullptr;
+	}
+
+	double GetNumber(const char* key, double fallback) const {
+		const JsonValue* value = Find(key);
+		return value && value->type == Type::Number ? value->number : fallback;
+	}
+
+	// Element i of the named array member, nullptr if out of range
+	const JsonValue* GetElement(const char* key, int i) const {
+		const JsonValue* array = Find(key);
+		if (!array || array->type != Type::Array || i < 0 || (size_t)i >= array->elements.size()) {
+			return nullptr;
+		}
+		return &array->elements[i];
+	}
+};
+
+static const char* SkipWhitespace(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+		p++;
+	}
+	return p;
+}
+
+static void AppendUtf8(std::string& output, unsigned int codepoint) {
+	if (codepoint < 0x80) {
+		output += (char)codepoint;
+	}
+	else if (codepoint < 0x800) {
+		output += (char)(0xC0 | (codepoint >> 6));
+		output += (char)(0x80 | (codepoint & 0x3F));
+	}
+	else {
+		output += (char)(0xE0 | (codepoint >> 12));
+		output += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+		output += (char)(0x80 | (codepoint & 0x3F));
+	}
+}
+
+// p points after the opening quote. Returns nullptr on a malformed string
+static const char* ParseJsonString(const char* p, const char* end, std::string& output) {
+	while (p < end && *p != '"') {
+		if (*p != '\\') {
+			output += *p++;
+			continue;
+		}
+		if (++p >= end) {
+			return nullptr;
+		}
+		switch (*p++) {
+			case '"':  output += '"'; break;
+			case '\\': output += '\\'; break;
+			case '/':  output += '/'; break;
+			case 'b':  output += '\b'; break;
+			case 'f':  output += '\f'; break;
+			case 'n':  output += '\n'; break;
+			case 'r':  output += '\r'; break;
+			case 't':  output += '\t'; break;
+			case 'u': {
+				unsigned int codepoint = 0;
+				if (end - p < 4 || std::from_chars(p, p + 4, codepoint, 16).ptr != p + 4) {
+					return nullptr;
+				}
+				AppendUtf8(output, codepoint); // Surrogate pairs are kept as two code points, names are ASCII in practice
+				p += 4;
+				break;
+			}
+			default:   return nullptr;
+		}
+	}
+	return p < end ? p + 1 : nullptr;
+}
+
+// Returns nullptr on a syntax error
+static const char* ParseJsonValue(const char* p, const char* end, JsonValue& value, int depth) {
+	p = SkipWhitespace(p, end);
+	if (p >= end || depth > JSON_MAX_DEPTH) {
+		return nullptr;
+	}
+
+	switch (*p) {
+		case '{': {
+			value.type = JsonValue::Type::Object;
+			p = SkipWhitespace(p + 1, end);
+			if (p < end && *p == '}') {
+				return p + 1;
+			}
+			while (p < end) {
+				std::string key;
+				if (*p != '"' || (p = ParseJsonString(p + 1, end, key)) == nullptr) {
+					return nullptr;
+				}
+				p = SkipWhitespace(p, end);
+				if (p >= end || *p != ':') {
+					return nullptr;
+				}
+				value.members.emplace_back(std::move(key), JsonValue());
+				if ((p = ParseJsonValue(p + 1, end, value.members.back().second, depth + 1)) == nullptr) {
+					return nullptr;
+				}
+				p = SkipWhitespace(p, end);
+				if (p < end && *p == '}') {
+					return p + 1;
+				}
+				if (p >= end || *p != ',') {
+					return nullptr;
+				}
+				p = SkipWhitespace(p + 1, end);
+			}
+			return nullptr;
+		}
+		case '[': {
+			value.type = JsonValue::Type::Array;
+			p = SkipWhitespace(p + 1, end);
+			if (p < end && *p == ']') {
+				return p + 1;
+			}
+			while (p < end) {
+				value.elements.emplace_back();
+				if ((p = ParseJsonValue(p, end, value.elements.back(), depth + 1)) == nullptr) {
+					return nullptr;
+				}
+				p = SkipWhitespace(p, end);
+				if (p < end && *p == ']') {
+					return p + 1;
+				}
+				if (p >= end || *p != ',') {
+					return nullptr;
+				}
+				p++;
+			}
+			return nullptr;
+		}
+		case '"':
+			value.type = JsonValue::Type::String;
+			return ParseJsonString(p + 1, end, value.string);
+		case 't':
+		case 'f': {
+			const char* literal = *p == 't' ? "true" : "false";
+			size_t length = strlen(literal);
+			if ((size_t)(end - p) < length || memcmp(p, literal, length) != 0) {
+				return nullptr;
+			}
+			value.type = JsonValue::Type::Bool;
+			value.boolean = *p == 't';
+			return p + length;
+		}
+		case 'n':
+			if (end - p < 4 || memcmp(p, "null", 4) != 0) {
+				return nullptr;
+			}
+			return p + 4;
+		default: {
+			value.type = JsonValue::Type::Number;
+			std::from_chars_result result = std::from_chars(p, end, value.number);
+			return result.ec == std::errc() ? result.ptr : nullptr;
+		}
+	}
+}
+
+struct GltfBuffer {
+	const unsigned char* data;
+	size_t size;
+};
+
+// An accessor resolved to a pointer into a mapped buffer
+struct GltfAccessor {
+	const unsigned char* data; // First element, nullptr if the accessor has no buffer view (all zeros)
+	size_t stride; // Bytes between elements
+	unsigned int componentType; // GL enum, glTF uses the same values
+	unsigned int componentCount;
+	bool normalized;
+	unsigned int count;
+};
+
+static unsigned int GetComponentCount(const std::string& type) {
+	if (type == "SCALAR") return 1;
+	if (type == "VEC2")   return 2;
+	if (type == "VEC3")   return 3;
+	if (type == "VEC4")   return 4;
+	return 0; // Matrices are never vertex attributes here
+}
+
+static unsigned int GetComponentSize(unsigned int componentType) {
+	switch (componentType) {
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:  return 1;
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT: return 2;
+		case GL_UNSIGNED_INT:
+		case GL_FLOAT:          return 4;
+		default:                return 0;
+	}
+}
+
+static bool ResolveAccessor(const JsonValue& gltf, const std::vector<GltfBuffer>& buffers, int index, GltfAccessor& accessor, std::string& error) {
+	const JsonValue* json = gltf.GetElement("accessors", index);
+	if (!json) {
+		error = "accessor index out of range";
+		return false;
+	}
+	if (json->Find("sparse")) {
+		error = "sparse accessors are not supported";
+		return false;
+	}
+
+	const JsonValue* type = json->Find("type");
+	accessor.componentType = (unsigned int)json->GetNumber("componentType", 0);
+	accessor.componentCount = type ? GetComponentCount(type->string) : 0;
+	accessor.count = (unsigned int)json->GetNumber("count", 0);
+	const JsonValue* normalized = json->Find("normalized");
+	accessor.normalized = normalized && normalized->boolean;
+
+	const unsigned int componentSize = GetComponentSize(accessor.componentType);
+	if (componentSize == 0 || accessor.componentCount == 0) {
+		error = "unsupported accessor format";
+		return false;
+	}
+	const size_t elementSize = (size_t)componentSize * accessor.componentCount;
+
+	const JsonValue* viewIndex = json->Find("bufferView");
+	if (!viewIndex) {
+		accessor.data = nullptr; // Spec: no buffer view means every element is zero
+		accessor.stride = 0;
+		return true;
+	}
+	const JsonValue* view = gltf.GetElement("bufferViews", (int)viewIndex->number);
+	if (!view) {
+		error = "buffer view index out of range";
+		return false;
+	}
+	int bufferIndex = (int)view->GetNumber("buffer", -1);
+	if (bufferIndex < 0 || (size_t)bufferIndex >= buffers.size()) {
+		error = "buffer index out of range";
+		return false;
+	}
+
+	const GltfBuffer& buffer = buffers[bufferIndex];
+	size_t offset = (size_t)view->GetNumber("byteOffset", 0) + (size_t)json->GetNumber("byteOffset", 0);
+	size_t viewEnd = (size_t)view->GetNumber("byteOffset", 0) + (size_t)view->GetNumber("byteLength", 0);
+	accessor.stride = (size_t)view->GetNumber("byteStride", (double)elementSize);
+	if (accessor.count > 0 && (viewEnd > buffer.size || offset + (accessor.count - 1) * accessor.stride + elementSize > viewEnd)) {
+		error = "accessor runs past the end of its buffer";
+		return false;
+	}
+	accessor.data = buffer.data + offset;
+	return true;
+}
+
+// Reads element i of the accessor as floats, applying the normalization rules of the spec
+static void ReadAccessor(const GltfAccessor& accessor, unsigned int i, float* values) {
+	if (!accessor.data) {
+		std::fill(values, values + accessor.componentCount, 0.0f);
+		return;
+	}
+	const unsigned char* element = accessor.data + i * accessor.stride;
+	for (unsigned int c = 0; c < accessor.componentCount; c++) {
+		switch (accessor.componentType) {
+			case GL_FLOAT:
+				memcpy(&values[c], element + c * 4, 4);
+				break;
+			case GL_UNSIGNED_BYTE: {
+				unsigned char v = element[c];
+				values[c] = accessor.normalized ? v / 255.0f : v;
+				break;
+			}
+			case GL_BYTE: {
+				signed char v = (signed char)element[c];
+				values[c] = accessor.normalized ? std::max(v / 127.0f, -1.0f) : v;
+				break;
+			}
+			case GL_UNSIGNED_SHORT: {
+				unsigned short v;
+				memcpy(&v, element + c * 2, 2);
+				values[c] = accessor.normalized ? v / 65535.0f : v;
+				break;
+			}
+			case GL_SHORT: {
+				short v;
+				memcpy(&v, element + c * 2, 2);
+				values[c] = accessor.normalized ? std::max(v / 32767.0f, -1.0f) : v;
+				break;
+			}
+			case GL_UNSIGNED_INT: {
+				unsigned int v;
+				memcpy(&v, element + c * 4, 4);
+				values[c] = (float)v;
+				break;
+			}
+		}
+	}
+}
+
+static unsigned int ReadIndex(const GltfAccessor& accessor, unsigned int i) {
+	const unsigned char* element = accessor.data + i * accessor.stride;
+	switch (accessor.componentType) {
+		case GL_UNSIGNED_BYTE:  return element[0];
+		case GL_UNSIGNED_SHORT: { unsigned short v; memcpy(&v, element, 2); return v; }
+		default:                { unsigned int v; memcpy(&v, element, 4); return v; }
+	}
+}
+
+static const char* GetAttributeName(MeshAttribute attribute) {
+	switch (attribute) {
+		case MeshAttribute::Position: return "POSITION";
+		case MeshAttribute::Normal:   return "NORMAL";
+		case MeshAttribute::TexCoord: return "TEXCOORD_0";
+		case MeshAttribute::Color:    return "COLOR_0";
+	}
+	return "";
+}
+
+// Appends one triangle primitive to the mesh
+static bool LoadPrimitive(const JsonValue& gltf, const JsonValue& primitive, const std::vector<GltfBuffer>& buffers,
+	const std::vector<MeshAttribute>& attributes, MeshData& mesh, std::string& error)
+{
+	const JsonValue* primitiveAttributes = primitive.Find("attributes");
+	const JsonValue* position = primitiveAttributes ? primitiveAttributes->Find("POSITION") : nullptr;
+	if (!position) {
+		error = "primitive without POSITION";
+		return false;
+	}
+	GltfAccessor positions;
+	if (!ResolveAccessor(gltf, buffers, (int)position->number, positions, error)) {
+		return false;
+	}
+
+	const std::vector<VertexBufferElement>& elements = mesh.layout.GetElements();
+	std::vector<GltfAccessor> sources(elements.size());
+	std::vector<bool> present(elements.size(), false);
+	for (size_t e = 0; e < elements.size(); e++) {
+		const JsonValue* index = primitiveAttributes->Find(GetAttributeName(attributes[e]));
+		if (!index) {
+			continue;
+		}
+		if (!ResolveAccessor(gltf, buffers, (int)index->number, sources[e], error)) {
+			return false;
+		}
+		if (sources[e].count < positions.count) {
+			error = "attribute accessor is shorter than POSITION";
+			return false;
+		}
+		present[e] = true;
+	}
+
+	const unsigned int baseVertex = mesh.vertexCount;
+	const unsigned int vertexCount = positions.count;
+	const unsigned int stride = mesh.layout.GetStride();
+	mesh.vertices.resize((size_t)(baseVertex + vertexCount) * stride);
+
+	unsigned int offset = 0;
+	for (size_t e = 0; e < elements.size(); e++) {
+		const VertexBufferElement& element = elements[e];
+		const GltfAccessor& source = sources[e];
+		unsigned char* destination = mesh.vertices.data() + (size_t)baseVertex * stride + offset;
+
+		if (present[e] && source.data && source.componentType == GL_FLOAT && element.type == GL_FLOAT && element.count == source.componentCount) {
+			// Same format on both sides, copy straight out of the mapping
+			for (unsigned int v = 0; v < vertexCount; v++) {
+				memcpy(destination + (size_t)v * stride, source.data + v * source.stride, element.count * sizeof(float));
+			}
+		}
+		else {
+			float values[4];
+			for (unsigned int v = 0; v < vertexCount; v++) {
+				if (present[e]) {
+					ReadAccessor(source, v, values);
+				}
+				WriteVertexElement(destination + (size_t)v * stride, element, values, present[e] ? source.componentCount : 0);
+			}
+		}
+		offset += element.GetSize();
+	}
+	mesh.vertexCount += vertexCount;
+
+	const JsonValue* indicesIndex = primitive.Find("indices");
+	if (!indicesIndex) {
+		for (unsigned int v = 0; v < vertexCount; v++) {
+			mesh.indices.push_back(baseVertex + v); // Non-indexed, every three vertices form a triangle
+		}
+		return true;
+	}
+
+	GltfAccessor indices;
+	if (!ResolveAccessor(gltf, buffers, (int)indicesIndex->number, indices, error)) {
+		return false;
+	}
+	if (!indices.data || indices.componentCount != 1 || indices.componentType == GL_FLOAT
+		|| indices.componentType == GL_BYTE || indices.componentType == GL_SHORT) {
+		error = "invalid index accessor";
+		return false;
+	}
+	size_t first = mesh.indices.size();
+	mesh.indices.resize(first + indices.count);
+	for (unsigned int i = 0; i < indices.count; i++) {
+		unsigned int index = ReadIndex(indices, i);
+		if (index >= vertexCount) {
+			error = "index out of range";
+			return false;
+		}
+		mesh.indices[first + i] = baseVertex + index;
+	}
+	return true;
+}
+
+bool LoadGltf(const std::string& filepath, const VertexBufferLayout& layout, const std::vector<MeshAttribute>& attributes,
+	MeshData& mesh, const MeshLoadOptions& options)
+{
+	if (layout.GetElements().size() != attributes.size()) {
+		std::cerr << "Mesh layout has " << layout.GetElements().size() << " elements but " << attributes.size() << " attributes were given" << std::endl;
+		return false;
+	}
+
+	MappedFile file(filepath);
+	if (!file.IsOpen()) {
+		std::cerr << "Failed to open mesh '" << filepath << "'" << std::endl;
+		return false;
+	}
+
+	// A .glb is a 12 byte header then a JSON chunk and an optional BIN chunk, a .gltf is JSON only
+	const unsigned char* data = file.GetData();
+	const size_t size = file.GetSize();
+	const char* json = reinterpret_cast<const char*>(data);
+	size_t jsonSize = size;
+	GltfBuffer binChunk = { nullptr, 0 };
+
+	uint32_t header[5] = {}; // magic, version, length, JSON chunk length, JSON chunk type
+	if (size >= sizeof(header)) {
+		memcpy(header, data, sizeof(header));
+	}
+	if (header[0] == GLB_MAGIC) {
+		if (header[1] != 2 || header[4] != GLB_CHUNK_JSON || 20 + (size_t)header[3] > size) {
+			std::cerr << "Failed to load glTF '" << filepath << "': unsupported or corrupt GLB header" << std::endl;
+			return false;
+		}
+		json = reinterpret_cast<const char*>(data + 20);
+		jsonSize = header[3];
+		size_t binOffset = 20 + (((size_t)header[3] + 3) & ~(size_t)3);
+		uint32_t binHeader[2];
+		if (binOffset + sizeof(binHeader) <= size) {
+			memcpy(binHeader, data + binOffset, sizeof(binHeader));
+			if (binHeader[1] == GLB_CHUNK_BIN && binOffset + 8 + binHeader[0] <= size) {
+				binChunk = { data + binOffset + 8, binHeader[0] };
+			}
+		}
+	}
+
+	JsonValue gltf;
+	if (!ParseJsonValue(json, json + jsonSize, gltf, 0) || gltf.type != JsonValue::Type::Object) {
+		std::cerr << "Failed to load glTF '" << filepath << "': malformed JSON" << std::endl;
+		return false;
+	}
+
+	// External buffers are mapped too, relative to the .gltf
+	std::string directory = filepath.substr(0, filepath.find_last_of("/\\") + 1);
+	std::vector<std::unique_ptr<MappedFile>> externalFiles;
+	std::vector<GltfBuffer> buffers;
+	const JsonValue* bufferList = gltf.Find("buffers");
+	for (size_t i = 0; bufferList && i < bufferList->elements.size(); i++) {
+		const JsonValue* uri = bufferList->elements[i].Find("uri");
+		if (!uri) {
+			buffers.push_back(binChunk); // The GLB-stored buffer
+			continue;
+		}
+		if (uri->string.compare(0, 5, "data:") == 0) {
+			std::cerr << "Failed to load glTF '" << filepath << "': embedded base64 buffers are not supported, export as .glb" << std::endl;
+			return false;
+		}
+		externalFiles.emplace_back(new MappedFile(directory + uri->string));
+		if (!externalFiles.back()->IsOpen()) {
+			std::cerr << "Failed to load glTF '" << filepath << "': missing buffer '" << uri->string << "'" << std::endl;
+			return false;
+		}
+		buffers.push_back({ externalFiles.back()->GetData(), externalFiles.back()->GetSize() });
+	}
+
+	mesh.layout = layout;
+	mesh.vertexCount = 0;
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	const JsonValue* meshes = gltf.Find("meshes");
+	for (size_t m = 0; meshes && m < meshes->elements.size(); m++) {
+		const JsonValue* primitives = meshes->elements[m].Find("primitives");
+		for (size_t p = 0; primitives && p < primitives->elements.size(); p++) {
+			const JsonValue& primitive = primitives->elements[p];
+			if (primitive.GetNumber("mode", GL_TRIANGLES) != GL_TRIANGLES) {
+				continue; // Points, lines and strips are not loaded
+			}
+			std::string error;
+			if (!LoadPrimitive(gltf, primitive, buffers, attributes, mesh, error)) {
+				std::cerr << "Failed to load glTF '" << filepath << "': " << error << std::endl;
+				return false;
+			}
+		}
+	}
+
+	if (options.optimize) {
+		mesh.optimization = OptimizeMeshData(mesh, attributes);
+	}
+	return true;
+}
\ No newline at end of file
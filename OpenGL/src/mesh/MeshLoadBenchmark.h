@@ -0,0 +1,6 @@
+#pragma once
+
+// Writes a generated 1M-triangle OBJ (positions, texture coordinates and normals) to a temporary
+// file and times LoadObj on one thread and on every hardware thread. Prints a table to stdout,
+// needs no GL context.
+void RunMeshLoadBenchmark();
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "MeshLoader.h"
+#include "MeshOptimizer.h"
+
+#include <cctype>
+#include <cstring>
+#include <iostream>
+
+static bool EndsWith(const std::string& value, const char* suffix) {
+	size_t length = strlen(suffix);
+	if (value.size() < length) {
+		return false;
+	}
+	for (size_t i = 0; i < length; i++) {
+		if (tolower((unsigned char)value[value.size() - length + i]) != suffix[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool LoadMesh(const std::string& filepath, const VertexBufferLayout& layout, const std::vector<MeshAttribute>& attributes,
+	MeshData& mesh, const MeshLoadOptions& options)
+{
+	if (EndsWith(filepath, ".obj")) {
+		return LoadObj(filepath, layout, attributes, mesh, options);
+	}
+	if (EndsWith(filepath, ".gltf") || EndsWith(filepath, ".glb")) {
+		return LoadGltf(filepath, layout, attributes, mesh, options);
+	}
+	std::cerr << "Unknown mesh format '" << filepath << "'" << std::endl;
+	return false;
+}
+
+MeshOptimizationReport OptimizeMeshData(MeshData& mesh, const std::vector<MeshAttribute>& attributes) {
+	const unsigned int stride = mesh.layout.GetStride();
+	const std::vector<VertexBufferElement>& elements = mesh.layout.GetElements();
+
+	unsigned int offset = 0;
+	for (size_t i = 0; i < elements.size(); i++) {
+		if (attributes[i] == MeshAttribute::Position && elements[i].type == GL_FLOAT && elements[i].count >= 3) {
+			MeshOptimizationReport report = OptimizeMesh(mesh.vertices, mesh.indices, stride, offset);
+			mesh.vertexCount = (unsigned int)(mesh.vertices.size() / stride);
+			return report;
+		}
+		offset += elements[i].GetSize();
+	}
+
+	// No float positions to sort clusters by, keep the cache and fetch passes
+	const unsigned int indexCount = (unsigned int)mesh.indices.size();
+	MeshOptimizationReport report;
+	report.before = AnalyzeVertexCache(mesh.indices.data(), indexCount, mesh.vertexCount);
+	report.verticesBefore = mesh.vertexCount;
+	OptimizeVertexCache(mesh.indices.data(), mesh.indices.data(), indexCount, mesh.vertexCount);
+	std::vector<unsigned char> reordered(mesh.vertices.size());
+	mesh.vertexCount = OptimizeVertexFetch(reordered.data(), mesh.indices.data(), indexCount, mesh.vertices.data(), mesh.vertexCount, stride);
+	reordered.resize((size_t)mesh.vertexCount * stride);
+	mesh.vertices.swap(reordered);
+	report.after = AnalyzeVertexCache(mesh.indices.data(), indexCount, mesh.vertexCount);
+	report.verticesAfter = mesh.vertexCount;
+	return report;
+}
\ No newline at end of file
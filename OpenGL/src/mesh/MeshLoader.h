@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../buffers/VertexBufferLayout.h"
+#include "MeshOptimizer.h"
+
+// What a layout element is filled with. Missing attributes read as (0, 0, 0, 1).
+enum class MeshAttribute {
+	Position, // xyz
+	Normal, // xyz
+	TexCoord, // uv, first set
+	Color // rgba, OBJ "v x y z r g b" or glTF COLOR_0
+};
+
+struct MeshLoadOptions {
+	bool optimize = false; // Run OptimizeMesh on the result, worth it when cooking assets
+	unsigned int threadCount = 0; // Threads for OBJ parsing, 0 uses every hardware thread
+};
+
+// Interleaved geometry ready for VertexBuffer/IndexBuffer (or MeshArena::Add)
+struct MeshData {
+	std::vector<unsigned char> vertices; // vertexCount * layout.GetStride() bytes
+	std::vector<unsigned int> indices; // Triangle list
+	VertexBufferLayout layout;
+	unsigned int vertexCount = 0;
+	MeshOptimizationReport optimization = {}; // ACMR/ATVR before and after, filled when MeshLoadOptions::optimize ran
+};
+
+// Loads an OBJ, glTF or GLB file, picked by extension, and interleaves it as described by layout,
+// where element i of the layout is filled with attributes[i]. Float, half, normalized 8/16-bit
+// and 10_10_10_2 elements are converted on the fly.
+bool LoadMesh(const std::string& filepath, const VertexBufferLayout& layout, const std::vector<MeshAttribute>& attributes,
+	MeshData& mesh, const MeshLoadOptions& options = MeshLoadOptions());
+
+// Wavefront OBJ, parsed in parallel line-aligned chunks straight from the file mapping.
+// Polygons are fan triangulated, groups and materials are ignored.
+bool LoadObj(const std::string& filepath, const VertexBufferLayout& layout, const std::vector<MeshAttribute>& attributes,
+	MeshData& mesh, const MeshLoadOptions& options = MeshLoadOptions());
+
+// glTF 2.0, .glb or .gltf with external .bin buffers. Buffers are mapped and accessors read in place.
+// Every triangle primitive of every mesh is merged, node transforms are not applied.
+bool LoadGltf(const std::string& filepath, const VertexBufferLayout& layout, const std::vector<MeshAttribute>& attributes,
+	MeshData& mesh, const MeshLoadOptions& options = MeshLoadOptions());
+
+// Runs OptimizeMesh on loaded geometry and returns its report. Overdraw ordering needs float
+// positions, with quantized positions only the vertex cache and vertex fetch passes run.
+MeshOptimizationReport OptimizeMeshData(MeshData& mesh, const std::vector<MeshAttribute>& attributes);
\ No newline at end of file
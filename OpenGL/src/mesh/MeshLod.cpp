@@ -0,0 +1,81 @@
+#include "MeshLod.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+MeshLodChain BuildLodChain(const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int positionStride, unsigned int vertexCount,
+	unsigned int maxLevels, float reduction)
+{
+	MeshLodChain chain;
+	maxLevels = std::max(1u, std::min(maxLevels, MESH_MAX_LODS));
+
+	// Bounding sphere around the box of the referenced vertices
+	auto position = [&](unsigned int v) {
+		const float* p = (const float*)((const unsigned char*)positions + (size_t)v * positionStride);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+	glm::vec3 minimum(FLT_MAX), maximum(-FLT_MAX);
+	for (unsigned int i = 0; i < indexCount; i++) {
+		glm::vec3 p = position(indices[i]);
+		minimum = glm::min(minimum, p);
+		maximum = glm::max(maximum, p);
+	}
+	chain.center = indexCount ? (minimum + maximum) * 0.5f : glm::vec3(0.0f);
+	chain.radius = 0.0f;
+	for (unsigned int i = 0; i < indexCount; i++) {
+		chain.radius = std::max(chain.radius, glm::length(position(indices[i]) - chain.center));
+	}
+
+	chain.indices.assign(indices, indices + indexCount);
+	chain.levels.push_back({ 0, indexCount, 0.0f });
+
+	std::vector<unsigned int> level(indices, indices + indexCount);
+	float error = 0.0f;
+	while (chain.levels.size() < maxLevels) {
+		unsigned int currentCount = (unsigned int)level.size();
+		unsigned int targetCount = (unsigned int)(currentCount / 3 * reduction) * 3;
+		float levelError = 0.0f;
+		unsigned int count = SimplifyMesh(level.data(), level.data(), currentCount, positions, positionStride, vertexCount, targetCount, FLT_MAX, &levelError);
+		if (count == 0 || count > currentCount * 0.95f) {
+			break; // Locked borders or flips stopped it, another level would look the same
+		}
+		level.resize(count);
+		OptimizeVertexCache(level.data(), level.data(), count, vertexCount);
+
+		// Each level is simplified from the previous one, so the errors add up
+		error += levelError;
+		chain.levels.push_back({ (unsigned int)chain.indices.size(), count, error });
+		chain.indices.insert(chain.indices.end(), level.begin(), level.end());
+	}
+	return chain;
+}
+
+float GetLodProjectionScale(float fovY, float viewportHeight) {
+	return viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+}
+
+unsigned int SelectLod(const MeshLodChain& chain, const glm::mat4& model, const glm::vec3& cameraPosition,
+	float projectionScale, float maxPixelError)
+{
+	glm::vec3 center = glm::vec3(model * glm::vec4(chain.center, 1.0f));
+	float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	float distance = glm::length(center - cameraPosition) - chain.radius * scale;
+	if (distance <= 0.0f) {
+		return 0; // Camera inside the bounds
+	}
+
+	return SelectLod(chain, scale * projectionScale / distance, maxPixelError);
+}
+
+unsigned int SelectLod(const MeshLodChain& chain, float pixelsPerUnit, float maxPixelError) {
+	for (unsigned int i = (unsigned int)chain.levels.size(); i-- > 1;) {
+		if (chain.levels[i].error * pixelsPerUnit <= maxPixelError) {
+			return i;
+		}
+	}
+	return 0;
+}
\ No newline at end of file
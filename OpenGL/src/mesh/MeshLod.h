@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+const unsigned int MESH_MAX_LODS = 8;
+
+// One level of detail, a range of MeshLodChain::indices
+struct MeshLodLevel {
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	float error; // Object-space distance from the full mesh, 0 for level 0
+};
+
+// Every level indexes the same vertices, so the chain goes into a MeshArena as one mesh
+// (vertices once, all levels' indices back to back) and a level is drawn as a sub-range:
+//
+//     MeshHandle handle = arena.Add(vertices, vertexCount, chain.indices.data(), (unsigned int)chain.indices.size());
+//     renderer.Draw(arena, handle, chain.levels[SelectLod(chain, model, cameraPosition, scale)], shader);
+struct MeshLodChain {
+	std::vector<unsigned int> indices; // Level 0 (the full mesh) first
+	std::vector<MeshLodLevel> levels;
+	glm::vec3 center; // Bounding sphere in object space
+	float radius;
+};
+
+// Builds up to maxLevels levels, each simplified to about reduction times the triangles of the
+// previous one, at import or cook time. Stops early once a level no longer shrinks.
+// Every level is reordered for the vertex cache.
+MeshLodChain BuildLodChain(const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int positionStride, unsigned int vertexCount,
+	unsigned int maxLevels = 5, float reduction = 0.5f);
+
+// Pixels per world unit at distance 1, e.g. GetLodProjectionScale(glm::radians(45.0f), 540.0f)
+float GetLodProjectionScale(float fovY, float viewportHeight);
+
+// Coarsest level whose error, projected to the screen for this instance, stays under maxPixelError.
+// Uses the nearest point of the bounding sphere and the largest axis scale of model.
+unsigned int SelectLod(const MeshLodChain& chain, const glm::mat4& model, const glm::vec3& cameraPosition,
+	float projectionScale, float maxPixelError = 1.0f);
+
+// Same, for any projection: pixelsPerUnit is how many pixels one object-space unit covers at the
+// instance's nearest point, see RenderQueue for perspective and orthographic cameras alike
+unsigned int SelectLod(const MeshLodChain& chain, float pixelsPerUnit, float maxPixelError = 1.0f);
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include "MeshOptimizer.h"
+#include "../Renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "glm/glm.hpp"
+
+VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize) {
+	// Each vertex remembers the miss count at which it entered the cache, it is still cached while
+	// fewer than cacheSize misses happened since, which is exactly FIFO replacement
+	std::vector<unsigned int> cachedAt(vertexCount, 0);
+	unsigned int misses = 0;
+
+	for (unsigned int i = 0; i < indexCount; i++) {
+		unsigned int v = indices[i];
+		ASSERT(v < vertexCount);
+		if (cachedAt[v] == 0 || misses - cachedAt[v] >= cacheSize) {
+			cachedAt[v] = ++misses; // The miss that fetched it, counted from 1 so 0 means never seen
+		}
+	}
+
+	unsigned int triangleCount = indexCount / 3;
+	VertexCacheStats stats;
+	stats.transformedVertices = misses;
+	stats.acmr = triangleCount == 0 ? 0.0f : (float)misses / (float)triangleCount;
+	stats.atvr = vertexCount == 0 ? 0.0f : (float)misses / (float)vertexCount;
+	return stats;
+}
+
+// Scoring parameters from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+const int FORSYTH_CACHE_SIZE = (int)VERTEX_CACHE_SIZE;
+const int FORSYTH_MAX_VALENCE = 32; // Higher valences score the same as this one
+const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+struct ForsythScoreTable {
+	float cache[FORSYTH_CACHE_SIZE];
+	float valence[FORSYTH_MAX_VALENCE + 1];
+
+	ForsythScoreTable() {
+		for (int i = 0; i < FORSYTH_CACHE_SIZE; i++) {
+			if (i < 3) {
+				cache[i] = FORSYTH_LAST_TRIANGLE_SCORE; // Used by the last triangle, no bonus for order within it
+			}
+			else {
+				float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+				cache[i] = std::pow(1.0f - (i - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+			}
+		}
+		valence[0] = 0.0f;
+		for (int i = 1; i <= FORSYTH_MAX_VALENCE; i++) {
+			// Boost vertices with few triangles left so they get finished instead of stranded
+			valence[i] = FORSYTH_VALENCE_BOOST_SCALE * std::pow((float)i, -FORSYTH_VALENCE_BOOST_POWER);
+		}
+	}
+
+	inline float Score(int cachePosition, unsigned int liveTriangles) const {
+		if (liveTriangles == 0) {
+			return -1.0f; // Nothing left to draw with this vertex
+		}
+		float score = cachePosition >= 0 ? cache[cachePosition] : 0.0f;
+		return score + valence[std::min(liveTriangles, (unsigned int)FORSYTH_MAX_VALENCE)];
+	}
+};
+
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount) {
+	static const ForsythScoreTable table;
+	const unsigned int triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// Vertex -> triangle adjacency in one flat array, live triangles are kept at the front of each span
+	std::vector<unsigned int> liveTriangles(vertexCount, 0);
+	for (unsigned int i = 0; i < indexCount; i++) {
+		liveTriangles[indices[i]]++;
+	}
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+	for (unsigned int v = 0; v < vertexCount; v++) {
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+	}
+	std::vector<unsigned int> adjacency(indexCount);
+	std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		for (unsigned int k = 0; k < 3; k++) {
+			adjacency[fill[indices[t * 3 + k]]++] = t;
+		}
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; v++) {
+		vertexScore[v] = table.Score(-1, liveTriangles[v]);
+	}
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		const unsigned int* tri = indices + t * 3;
+		triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+	}
+
+	// Copy the input first so destination may alias indices
+	std::vector<unsigned int> source(indices, indices + indexCount);
+
+	unsigned int cache[FORSYTH_CACHE_SIZE + 3];
+	unsigned int cacheCount = 0;
+	unsigned int nextInputTriangle = 0; // Restart point when the cache offers no candidate
+
+	unsigned int best = 0;
+	for (unsigned int t = 1; t < triangleCount; t++) {
+		if (triangleScore[t] > triangleScore[best]) {
+			best = t;
+		}
+	}
+
+	for (unsigned int output = 0; output < triangleCount; output++) {
+		const unsigned int* tri = source.data() + best * 3;
+		destination[output * 3 + 0] = tri[0];
+		destination[output * 3 + 1] = tri[1];
+		destination[output * 3 + 2] = tri[2];
+		emitted[best] = true;
+
+		// Drop the triangle from its vertices' live spans
+		for (unsigned int k = 0; k < 3; k++) {
+			unsigned int v = tri[k];
+			unsigned int* span = adjacency.data() + adjacencyOffset[v];
+			unsigned int* end = span + liveTriangles[v];
+			std::swap(*std::find(span, end, best), *(end - 1));
+			liveTriangles[v]--;
+		}
+
+		// New cache: this triangle's vertices at the front, then the old contents in order
+		unsigned int newCache[FORSYTH_CACHE_SIZE + 3];
+		unsigned int newCount = 0;
+		for (unsigned int k = 0; k < 3; k++) {
+			newCache[newCount++] = tri[k];
+		}
+		for (unsigned int i = 0; i < cacheCount; i++) {
+			unsigned int v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) {
+				newCache[newCount++] = v;
+			}
+		}
+
+		// Rescore everything that moved, including the up to 3 vertices that just fell out
+		for (unsigned int i = 0; i < newCount; i++) {
+			unsigned int v = newCache[i];
+			cachePosition[v] = i < (unsigned int)FORSYTH_CACHE_SIZE ? (int)i : -1;
+			vertexScore[v] = table.Score(cachePosition[v], liveTriangles[v]);
+		}
+
+		float bestScore = -1.0f;
+		for (unsigned int i = 0; i < newCount; i++) {
+			unsigned int v = newCache[i];
+			const unsigned int* span = adjacency.data() + adjacencyOffset[v];
+			for (unsigned int j = 0; j < liveTriangles[v]; j++) {
+				unsigned int t = span[j];
+				const unsigned int* candidate = source.data() + t * 3;
+				triangleScore[t] = vertexScore[candidate[0]] + vertexScore[candidate[1]] + vertexScore[candidate[2]];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, (unsigned int)FORSYTH_CACHE_SIZE);
+		memcpy(cache, newCache, cacheCount * sizeof(unsigned int));
+
+		if (bestScore < 0.0f) {
+			// Dead end, every cached vertex is finished. Continue with the next triangle in input order
+			while (nextInputTriangle < triangleCount && emitted[nextInputTriangle]) {
+				nextInputTriangle++;
+			}
+			best = nextInputTriangle;
+		}
+	}
+}
+
+void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int positionStride, unsigned int vertexCount, unsigned int cacheSize)
+{
+	const unsigned int triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	auto position = [&](unsigned int v) {
+		const float* p = (const float*)((const unsigned char*)positions + (size_t)v * positionStride);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	// Cut clusters where all three vertices miss the cache, those are the points where the
+	// cache optimizer started over, so reordering whole clusters keeps the cache hits
+	std::vector<unsigned int> clusterStart;
+	std::vector<unsigned int> cachedAt(vertexCount, 0);
+	unsigned int misses = 0;
+	for (unsigned int t = 0; t < triangleCount; t++) {
+		unsigned int triangleMisses = 0;
+		for (unsigned int k = 0; k < 3; k++) {
+			unsigned int v = indices[t * 3 + k];
+			if (cachedAt[v] == 0 || misses - cachedAt[v] >= cacheSize) {
+				cachedAt[v] = ++misses;
+				triangleMisses++;
+			}
+		}
+		if (t == 0 || triangleMisses == 3) {
+			clusterStart.push_back(t);
+		}
+	}
+	clusterStart.push_back(triangleCount);
+
+	// Area weighted centroid and normal per cluster, and for the whole mesh
+	const unsigned int clusterCount = (unsigned int)clusterStart.size() - 1;
+	std::vector<float> sortKey(clusterCount);
+	std::vector<glm::vec3> clusterCentroid(clusterCount);
+	std::vector<glm::vec3> clusterNormal(clusterCount);
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (unsigned int c = 0; c < clusterCount; c++) {
+		glm::vec3 centroid(0.0f);
+		glm::vec3 normal(0.0f);
+		float area = 0.0f;
+		for (unsigned int t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+			glm::vec3 a = position(indices[t * 3 + 0]);
+			glm::vec3 b = position(indices[t * 3 + 1]);
+			glm::vec3 d = position(indices[t * 3 + 2]);
+			glm::vec3 cross = glm::cross(b - a, d - a);
+			float triangleArea = glm::length(cross);
+			centroid += (a + b + d) * (triangleArea / 3.0f);
+			normal += cross;
+			area += triangleArea;
+		}
+		clusterCentroid[c] = area > 0.0f ? centroid / area : position(indices[clusterStart[c] * 3]);
+		clusterNormal[c] = glm::length(normal) > 0.0f ? glm::normalize(normal) : glm::vec3(0.0f);
+		meshCentroid += centroid;
+		meshArea += area;
+	}
+	if (meshArea > 0.0f) {
+		meshCentroid /= meshArea;
+	}
+
+	// Outward facing clusters far from the centre are the likeliest occluders, draw them first
+	std::vector<unsigned int> order(clusterCount);
+	for (unsigned int c = 0; c < clusterCount; c++) {
+		sortKey[c] = glm::dot(clusterCentroid[c] - meshCentroid, clusterNormal[c]);
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return sortKey[a] > sortKey[b]; });
+
+	std::vector<unsigned int> source(indices, indices + indexCount); // destination may alias indices
+	unsigned int output = 0;
+	for (unsigned int c : order) {
+		unsigned int first = clusterStart[c] * 3;
+		unsigned int last = clusterStart[c + 1] * 3;
+		memcpy(destination + output, source.data() + first, (last - first) * sizeof(unsigned int));
+		output += last - first;
+	}
+}
+
+static uint64_t HashVertex(const unsigned char* vertex, unsigned int vertexSize) {
+	uint64_t hash = 14695981039346656037ull; // FNV-1a
+	for (unsigned int i = 0; i < vertexSize; i++) {
+		hash ^= vertex[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+unsigned int DeduplicateVertices(unsigned int* remap, const void* vertices, unsigned int vertexCount, unsigned int vertexSize) {
+	const unsigned char* data = static_cast<const unsigned char*>(vertices);
+
+	// Open addressing table of vertex indices, at most half full
+	size_t tableSize = 1;
+	while (tableSize < (size_t)vertexCount * 2) {
+		tableSize <<= 1;
+	}
+	const unsigned int EMPTY = 0xFFFFFFFF;
+	std::vector<unsigned int> table(tableSize, EMPTY);
+
+	unsigned int unique = 0;
+	for (unsigned int v = 0; v < vertexCount; v++) {
+		const unsigned char* vertex = data + (size_t)v * vertexSize;
+		size_t slot = (size_t)HashVertex(vertex, vertexSize) & (tableSize - 1);
+		while (table[slot] != EMPTY && memcmp(data + (size_t)table[slot] * vertexSize, vertex, vertexSize) != 0) {
+			slot = (slot + 1) & (tableSize - 1); // Linear probing
+		}
+		if (table[slot] == EMPTY) {
+			table[slot] = v;
+			unique++;
+		}
+		remap[v] = table[slot];
+	}
+	return unique;
+}
+
+unsigned int OptimizeVertexFetch(void* destination, unsigned int* indices, unsigned int indexCount,
+	const void* vertices, unsigned int vertexCount, unsigned int vertexSize)
+{
+	ASSERT(destination != vertices);
+	std::vector<unsigned int> remap(vertexCount);
+	DeduplicateVertices(remap.data(), vertices, vertexCount, vertexSize);
+
+	const unsigned int UNUSED = 0xFFFFFFFF;
+	std::vector<unsigned int> newIndex(vertexCount, UNUSED);
+	unsigned char* output = static_cast<unsigned char*>(destination);
+	const unsigned char* input = static_cast<const unsigned char*>(vertices);
+	unsigned int next = 0;
+
+	// Vertices are laid out in the order the GPU first fetches them
+	for (unsigned int i = 0; i < indexCount; i++) {
+		unsigned int v = remap[indices[i]];
+		if (newIndex[v] == UNUSED) {
+			newIndex[v] = next;
+			memcpy(output + (size_t)next * vertexSize, input + (size_t)v * vertexSize, vertexSize);
+			next++;
+		}
+		indices[i] = newIndex[v];
+	}
+	return next;
+}
+
+MeshOptimizationReport OptimizeMesh(std::vector<unsigned char>& vertices, std::vector<unsigned int>& indices,
+	unsigned int vertexSize, unsigned int positionOffset)
+{
+	const unsigned int vertexCount = (unsigned int)(vertices.size() / vertexSize);
+	const unsigned int indexCount = (unsigned int)indices.size();
+
+	MeshOptimizationReport report;
+	report.before = AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+	report.verticesBefore = vertexCount;
+
+	OptimizeVertexCache(indices.data(), indices.data(), indexCount, vertexCount);
+	OptimizeOverdraw(indices.data(), indices.data(), indexCount,
+		(const float*)(vertices.data() + positionOffset), vertexSize, vertexCount);
+
+	std::vector<unsigned char> reordered(vertices.size());
+	unsigned int newVertexCount = OptimizeVertexFetch(reordered.data(), indices.data(), indexCount, vertices.data(), vertexCount, vertexSize);
+	reordered.resize((size_t)newVertexCount * vertexSize);
+	vertices.swap(reordered);
+
+	report.after = AnalyzeVertexCache(indices.data(), indexCount, newVertexCount);
+	report.verticesAfter = newVertexCount;
+	return report;
+}
\ No newline at end of file
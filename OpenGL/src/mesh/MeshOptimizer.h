@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+// Entries of the post-transform vertex cache every pass below models, so the cache order, the
+// overdraw clusters and the reports all agree on it
+const unsigned int VERTEX_CACHE_SIZE = 32;
+
+// Post-transform vertex cache efficiency of an index buffer, measured with a FIFO cache
+struct VertexCacheStats {
+	unsigned int transformedVertices; // Cache misses, i.e. vertex shader invocations
+	float acmr; // Average cache miss ratio: misses per triangle, 0.5 is ideal for a regular grid, 3 is worst
+	float atvr; // Average transformed vertex ratio: misses per unique vertex, 1 is ideal
+};
+
+// Before/after numbers from OptimizeMesh
+struct MeshOptimizationReport {
+	VertexCacheStats before;
+	VertexCacheStats after;
+	unsigned int verticesBefore;
+	unsigned int verticesAfter; // After deduplication and dropping unreferenced vertices
+};
+
+// Simulates a FIFO post-transform cache of cacheSize entries over a triangle list
+VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// Reorders triangles for the post-transform vertex cache (Tom Forsyth's linear-speed algorithm).
+// destination may alias indices.
+void OptimizeVertexCache(unsigned int* destination, const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount);
+
+// Reorders the clusters of an already cache-optimized index buffer so triangles facing away from
+// the mesh centre are drawn first, which lets early-Z reject more of the rest. Clusters are cut
+// where the cache order restarts, so cache efficiency is kept. positions points at the first
+// position (3 floats), positionStride is the vertex size in bytes. destination may alias indices.
+void OptimizeOverdraw(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int positionStride, unsigned int vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// Fills remap[vertexCount] with the index of the first bit-identical vertex and returns the unique count
+unsigned int DeduplicateVertices(unsigned int* remap, const void* vertices, unsigned int vertexCount, unsigned int vertexSize);
+
+// Rewrites the vertices in the order the indices first use them, merging bit-identical vertices and
+// dropping unreferenced ones. indices are updated in place, returns the new vertex count.
+unsigned int OptimizeVertexFetch(void* destination, unsigned int* indices, unsigned int indexCount,
+	const void* vertices, unsigned int vertexCount, unsigned int vertexSize);
+
+// Runs every pass above in order (cache, overdraw, fetch) on an interleaved triangle mesh.
+// Meant for load time or the asset cooker, the mesh renders identically afterwards.
+MeshOptimizationReport OptimizeMesh(std::vector<unsigned char>& vertices, std::vector<unsigned int>& indices,
+	unsigned int vertexSize, unsigned int positionOffset);
\ No newline at end of file
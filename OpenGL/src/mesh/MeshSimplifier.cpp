@@ -0,0 +1,254 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// Symmetric 4x4 error quadric, sum of squared distances to the planes of the absorbed triangles,
+// each weighted by its area. Error / weight is a squared distance.
+struct Quadric {
+	float a00, a11, a22, a01, a02, a12; // n * n^T
+	float b0, b1, b2; // d * n
+	float c; // d * d
+	float weight;
+};
+
+static Quadric MakePlaneQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+	Quadric q = {};
+	glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+	float length = glm::length(normal);
+	if (length == 0.0f) {
+		return q; // Degenerate triangle, no plane
+	}
+	normal /= length;
+	float d = -glm::dot(normal, p0);
+	float w = length * 0.5f; // Triangle area
+
+	q.a00 = w * normal.x * normal.x;
+	q.a11 = w * normal.y * normal.y;
+	q.a22 = w * normal.z * normal.z;
+	q.a01 = w * normal.x * normal.y;
+	q.a02 = w * normal.x * normal.z;
+	q.a12 = w * normal.y * normal.z;
+	q.b0 = w * d * normal.x;
+	q.b1 = w * d * normal.y;
+	q.b2 = w * d * normal.z;
+	q.c = w * d * d;
+	q.weight = w;
+	return q;
+}
+
+static void AddQuadric(Quadric& q, const Quadric& other) {
+	q.a00 += other.a00; q.a11 += other.a11; q.a22 += other.a22;
+	q.a01 += other.a01; q.a02 += other.a02; q.a12 += other.a12;
+	q.b0 += other.b0; q.b1 += other.b1; q.b2 += other.b2;
+	q.c += other.c;
+	q.weight += other.weight;
+}
+
+// Squared distance from p to the quadric's planes, averaged by area
+static float GetQuadricError(const Quadric& q, const glm::vec3& p) {
+	float rx = q.a00 * p.x + q.a01 * p.y + q.a02 * p.z;
+	float ry = q.a01 * p.x + q.a11 * p.y + q.a12 * p.z;
+	float rz = q.a02 * p.x + q.a12 * p.y + q.a22 * p.z;
+	float error = rx * p.x + ry * p.y + rz * p.z + 2.0f * (q.b0 * p.x + q.b1 * p.y + q.b2 * p.z) + q.c;
+	return std::fabs(error) / (q.weight > 0.0f ? q.weight : 1.0f);
+}
+
+struct Collapse {
+	unsigned int from;
+	unsigned int to;
+	float error; // Squared distance
+};
+
+static inline uint64_t MakeEdgeKey(unsigned int a, unsigned int b) {
+	return ((uint64_t)a << 32) | b;
+}
+
+unsigned int SimplifyMesh(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int positionStride, unsigned int vertexCount,
+	unsigned int targetIndexCount, float targetError, float* resultError)
+{
+	auto position = [&](unsigned int v) {
+		const float* p = (const float*)((const unsigned char*)positions + (size_t)v * positionStride);
+		return glm::vec3(p[0], p[1], p[2]);
+	};
+
+	std::vector<unsigned int> result(indices, indices + indexCount - indexCount % 3);
+
+	std::vector<Quadric> quadrics(vertexCount, Quadric());
+	for (size_t i = 0; i < result.size(); i += 3) {
+		Quadric q = MakePlaneQuadric(position(result[i]), position(result[i + 1]), position(result[i + 2]));
+		for (int k = 0; k < 3; k++) {
+			AddQuadric(quadrics[result[i + k]], q);
+		}
+	}
+
+	// An edge without its opposite half-edge is on an open border, lock both ends
+	std::vector<bool> locked(vertexCount, false);
+	{
+		std::vector<uint64_t> halfEdges;
+		halfEdges.reserve(result.size());
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				halfEdges.push_back(MakeEdgeKey(result[i + k], result[i + (k + 1) % 3]));
+			}
+		}
+		std::sort(halfEdges.begin(), halfEdges.end());
+		for (uint64_t edge : halfEdges) {
+			unsigned int a = (unsigned int)(edge >> 32);
+			unsigned int b = (unsigned int)edge;
+			if (!std::binary_search(halfEdges.begin(), halfEdges.end(), MakeEdgeKey(b, a))) {
+				locked[a] = true;
+				locked[b] = true;
+			}
+		}
+	}
+
+	const float maxError = targetError < std::sqrt(FLT_MAX) ? targetError * targetError : FLT_MAX;
+	float largestError = 0.0f;
+	std::vector<uint64_t> edges;
+	std::vector<Collapse> collapses;
+	std::vector<unsigned int> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+	std::vector<unsigned int> adjacencyOffset(vertexCount + 1);
+	std::vector<unsigned int> adjacency;
+
+	// Each pass collapses the cheapest edges whose neighbourhoods do not overlap, then rebuilds
+	while (result.size() > targetIndexCount) {
+		const unsigned int triangleCount = (unsigned int)result.size() / 3;
+
+		edges.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (int k = 0; k < 3; k++) {
+				unsigned int a = result[i + k];
+				unsigned int b = result[i + (k + 1) % 3];
+				edges.push_back(MakeEdgeKey(std::min(a, b), std::max(a, b)));
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		// Collapse onto whichever end costs less, never moving a locked vertex
+		collapses.clear();
+		for (uint64_t edge : edges) {
+			unsigned int a = (unsigned int)(edge >> 32);
+			unsigned int b = (unsigned int)edge;
+			if (locked[a] && locked[b]) {
+				continue;
+			}
+			Quadric q = quadrics[a];
+			AddQuadric(q, quadrics[b]);
+			float errorAtB = locked[a] ? FLT_MAX : GetQuadricError(q, position(b));
+			float errorAtA = locked[b] ? FLT_MAX : GetQuadricError(q, position(a));
+			Collapse collapse = errorAtB <= errorAtA ? Collapse{ a, b, errorAtB } : Collapse{ b, a, errorAtA };
+			if (collapse.error <= maxError) {
+				collapses.push_back(collapse);
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+		// Vertex -> triangle adjacency for the flip test
+		std::fill(adjacencyOffset.begin(), adjacencyOffset.end(), 0);
+		for (unsigned int v : result) {
+			adjacencyOffset[v + 1]++;
+		}
+		for (unsigned int v = 0; v < vertexCount; v++) {
+			adjacencyOffset[v + 1] += adjacencyOffset[v];
+		}
+		adjacency.resize(result.size());
+		{
+			std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+			for (unsigned int t = 0; t < triangleCount; t++) {
+				for (int k = 0; k < 3; k++) {
+					adjacency[fill[result[t * 3 + k]]++] = t;
+				}
+			}
+		}
+
+		for (unsigned int v = 0; v < vertexCount; v++) {
+			remap[v] = v;
+		}
+		std::fill(touched.begin(), touched.end(), false);
+
+		const unsigned int trianglesToRemove = (unsigned int)(result.size() - targetIndexCount) / 3;
+		unsigned int removed = 0;
+		bool collapsed = false;
+
+		for (const Collapse& collapse : collapses) {
+			if (removed >= trianglesToRemove) {
+				break;
+			}
+			if (touched[collapse.from] || touched[collapse.to]) {
+				continue; // Its neighbourhood already changed this pass, the cost is stale
+			}
+
+			// Reject collapses that would flip a triangle around the moved vertex
+			const glm::vec3 target = position(collapse.to);
+			bool flips = false;
+			unsigned int shared = 0;
+			for (unsigned int j = adjacencyOffset[collapse.from]; j < adjacencyOffset[collapse.from + 1] && !flips; j++) {
+				const unsigned int* tri = &result[adjacency[j] * 3];
+				if (tri[0] == collapse.to || tri[1] == collapse.to || tri[2] == collapse.to) {
+					shared++; // Becomes degenerate and disappears
+					continue;
+				}
+				glm::vec3 p[3] = { position(tri[0]), position(tri[1]), position(tri[2]) };
+				glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+				for (int k = 0; k < 3; k++) {
+					if (tri[k] == collapse.from) {
+						p[k] = target;
+					}
+				}
+				glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+				flips = glm::dot(before, after) <= 0.0f;
+			}
+			if (flips) {
+				continue;
+			}
+
+			remap[collapse.from] = collapse.to;
+			AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+			largestError = std::max(largestError, collapse.error);
+			removed += shared;
+			collapsed = true;
+
+			// Freeze the one-ring of both ends until the next pass
+			for (unsigned int v : { collapse.from, collapse.to }) {
+				for (unsigned int j = adjacencyOffset[v]; j < adjacencyOffset[v + 1]; j++) {
+					const unsigned int* tri = &result[adjacency[j] * 3];
+					touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = true;
+				}
+			}
+		}
+		if (!collapsed) {
+			break;
+		}
+
+		// Apply the collapses and drop the triangles that became degenerate
+		size_t output = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			unsigned int a = remap[result[i]];
+			unsigned int b = remap[result[i + 1]];
+			unsigned int c = remap[result[i + 2]];
+			if (a != b && b != c && a != c) {
+				result[output++] = a;
+				result[output++] = b;
+				result[output++] = c;
+			}
+		}
+		result.resize(output);
+	}
+
+	std::copy(result.begin(), result.end(), destination);
+	if (resultError) {
+		*resultError = std::sqrt(largestError);
+	}
+	return (unsigned int)result.size();
+}
\ No newline at end of file
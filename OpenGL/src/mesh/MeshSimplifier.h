@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cfloat>
+
+// Reduces a triangle list towards targetIndexCount with quadric error metric edge collapses
+// (Garland and Heckbert). Only the indices change: every collapse moves one vertex onto a
+// neighbour, so the simplified mesh still indexes the original vertex buffer and all levels of
+// a LOD chain can share it. Vertices on open borders, which include UV and normal seams since
+// those split vertices, are never moved, so seams and silhouettes stay intact.
+// Stops early when no collapse under targetError (object-space distance) is left.
+// Returns the new index count, resultError receives the largest error introduced.
+// destination needs room for indexCount indices and may alias indices.
+unsigned int SimplifyMesh(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+	const float* positions, unsigned int positionStride, unsigned int vertexCount,
+	unsigned int targetIndexCount, float targetError = FLT_MAX, float* resultError = nullptr);
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include "MeshLoader.h"
+#include "VertexQuantizer.h"
+#include "../assets/MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <iostream>
+#include <thread>
+
+// Face indices are stored as written: 1-based absolute indices stay positive, 0 marks a missing
+// vt/vn, and negative (relative) indices are stored as the chunk-local index minus this bias,
+// because a chunk does not know how many vertices the chunks before it declared until all are parsed
+const int OBJ_MISSING_INDEX = 0;
+const int OBJ_RELATIVE_BIAS = 1 << 30;
+const size_t OBJ_MIN_CHUNK_SIZE = 256 * 1024; // Smaller files are not worth another thread
+const size_t OBJ_MIN_PARALLEL_ITEMS = 64 * 1024; // Fewer corners or vertices are resolved and interleaved inline
+
+struct ObjChunk {
+	const char* begin;
+	const char* end;
+	std::vector<float> positions; // xyz
+	std::vector<float> colors; // rgb for every position, white when the line has none
+	std::vector<float> texCoords; // uv
+	std::vector<float> normals; // xyz
+	std::vector<int> corners; // (v, vt, vn) per triangle corner, fan triangulated
+	std::string error;
+};
+
+// Runs task(i) for i in [0, count) on up to count threads, the caller's thread included.
+// With less than minWork units of work in total (bytes, vertices...) starting threads costs more
+// than it saves, and every task runs inline one after the other.
+template<typename Task>
+static void ParallelFor(unsigned int count, size_t work, size_t minWork, const Task& task) {
+	if (work < minWork) {
+		for (unsigned int i = 0; i < count; i++) {
+			task(i);
+		}
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(count);
+	for (unsigned int i = 1; i < count; i++) {
+		threads.emplace_back([&task, i]() { task(i); });
+	}
+	if (count > 0) {
+		task(0);
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+static inline const char* SkipSpaces(const char* p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		p++;
+	}
+	return p;
+}
+
+static inline const char* SkipLine(const char* p, const char* end) {
+	while (p < end && *p != '\n') {
+		p++;
+	}
+	return p < end ? p + 1 : end;
+}
+
+static inline bool AtLineEnd(const char* p, const char* end) {
+	return p >= end || *p == '\n' || *p == '\r' || *p == '#';
+}
+
+// Returns nullptr if there is no number at p
+static inline const char* ParseFloat(const char* p, const char* end, float& value) {
+	p = SkipSpaces(p, end);
+	if (p < end && *p == '+') {
+		p++; // from_chars rejects an explicit plus sign
+	}
+	std::from_chars_result result = std::from_chars(p, end, value);
+	return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+static inline int EncodeIndex(int index, size_t localCount) {
+	return index > 0 ? index : (int)localCount + index - OBJ_RELATIVE_BIAS;
+}
+
+// Returns nullptr on a malformed corner such as "1/x"
+static const char* ParseCorner(const char* p, const char* end, ObjChunk& chunk, int* corner) {
+	int index = 0;
+	std::from_chars_result result = std::from_chars(p, end, index);
+	if (result.ec != std::errc() || index == 0) {
+		return nullptr;
+	}
+	p = result.ptr;
+	corner[0] = EncodeIndex(index, chunk.positions.size() / 3);
+	corner[1] = OBJ_MISSING_INDEX;
+	corner[2] = OBJ_MISSING_INDEX;
+
+	for (int slot = 1; slot < 3 && p < end && *p == '/'; slot++) {
+		p++;
+		if (p < end && *p == '/') {
+			continue; // "v//vn"
+		}
+		result = std::from_chars(p, end, index);
+		if (result.ec != std::errc() || index == 0) {
+			return nullptr;
+		}
+		p = result.ptr;
+		size_t localCount = slot == 1 ? chunk.texCoords.size() / 2 : chunk.normals.size() / 3;
+		corner[slot] = EncodeIndex(index, localCount);
+	}
+	return p;
+}
+
+static void ParseChunk(ObjChunk& chunk) {
+	const char* p = chunk.begin;
+	const char* end = chunk.end;
+	std::vector<int> polygon;
+
+	while (p < end) {
+		p = SkipSpaces(p, end);
+		if (AtLineEnd(p, end)) {
+			p = SkipLine(p, end);
+			continue;
+		}
+
+		if (p[0] == 'v' && p + 1 < end && (p[1] == ' ' || p[1] == '\t')) {
+			float values[7];
+			unsigned int count = 0;
+			const char* next = p + 1;
+			while (count < 7 && (next = ParseFloat(next, end, values[count])) != nullptr) {
+				p = next;
+				count++;
+			}
+			if (count < 3) {
+				chunk.error = "vertex with fewer than 3 coordinates";
+				return;
+			}
+			chunk.positions.insert(chunk.positions.end(), values, values + 3);
+			if (count >= 6) {
+				chunk.colors.insert(chunk.colors.end(), values + count - 3, values + count); // "v x y z [w] r g b"
+			}
+			else {
+				chunk.colors.insert(chunk.colors.end(), 3, 1.0f);
+			}
+		}
+		else if (p[0] == 'v' && p + 2 < end && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+			float uv[2] = { 0.0f, 0.0f };
+			const char* next = ParseFloat(p + 2, end, uv[0]);
+			if (!next) {
+				chunk.error = "texture coordinate without values";
+				return;
+			}
+			p = next;
+			if ((next = ParseFloat(p, end, uv[1])) != nullptr) {
+				p = next;
+			}
+			chunk.texCoords.insert(chunk.texCoords.end(), uv, uv + 2);
+		}
+		else if (p[0] == 'v' && p + 2 < end && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+			float normal[3];
+			const char* next = p + 2;
+			for (int c = 0; c < 3; c++) {
+				if ((next = ParseFloat(next, end, normal[c])) == nullptr) {
+					chunk.error = "normal with fewer than 3 coordinates";
+					return;
+				}
+			}
+			p = next;
+			chunk.normals.insert(chunk.normals.end(), normal, normal + 3);
+		}
+		else if (p[0] == 'f' && p + 1 < end && (p[1] == ' ' || p[1] == '\t')) {
+			polygon.clear();
+			p++;
+			while (true) {
+				p = SkipSpaces(p, end);
+				if (AtLineEnd(p, end)) {
+					break;
+				}
+				int corner[3];
+				p = ParseCorner(p, end, chunk, corner);
+				if (!p) {
+					chunk.error = "malformed face";
+					return;
+				}
+				polygon.insert(polygon.end(), corner, corner + 3);
+			}
+			// Fan triangulation, fine for the convex polygons exporters write
+			const size_t cornerCount = polygon.size() / 3;
+			for (size_t i = 2; i < cornerCount; i++) {
+				chunk.corners.insert(chunk.corners.end(), polygon.begin(), polygon.begin() + 3);
+				chunk.corners.insert(chunk.corners.end(), polygon.begin() + (i - 1) * 3, polygon.begin() + (i + 1) * 3);
+			}
+		}
+		p = SkipLine(p, end); // Anything else (o, g, s, usemtl, mtllib...) is ignored
+	}
+}
+
+bool LoadObj(const std::string& filepath, const VertexBufferLayout& layout, const std::vector<MeshAttribute>& attributes,
+	MeshData& mesh, const MeshLoadOptions& options)
+{
+	const std::vector<VertexBufferElement>& elements = layout.GetElements();
+	if (elements.size() != attributes.size()) {
+		std::cerr << "Mesh layout has " << elements.size() << " elements but " << attributes.size() << " attributes were given" << std::endl;
+		return false;
+	}
+
+	MappedFile file(filepath);
+	if (!file.IsOpen()) {
+		std::cerr << "Failed to open mesh '" << filepath << "'" << std::endl;
+		return false;
+	}
+	const char* data = reinterpret_cast<const char*>(file.GetData());
+	const size_t size = file.GetSize();
+
+	unsigned int threadCount = options.threadCount ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+	unsigned int chunkCount = (unsigned int)std::min<size_t>(threadCount, size / OBJ_MIN_CHUNK_SIZE + 1);
+
+	// Split on line boundaries so every chunk parses on its own
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char* chunkBegin = data;
+	for (unsigned int i = 0; i < chunkCount; i++) {
+		const char* chunkEnd = i + 1 == chunkCount ? data + size : SkipLine(std::max(chunkBegin, data + size * (i + 1) / chunkCount), data + size);
+		chunks[i].begin = chunkBegin;
+		chunks[i].end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	ParallelFor(chunkCount, size, OBJ_MIN_CHUNK_SIZE, [&chunks](unsigned int i) { ParseChunk(chunks[i]); });
+
+	// Where each chunk's vertices start in the merged arrays
+	std::vector<size_t> positionBase(chunkCount), texCoordBase(chunkCount), normalBase(chunkCount), cornerBase(chunkCount);
+	size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0;
+	for (unsigned int i = 0; i < chunkCount; i++) {
+		if (!chunks[i].error.empty()) {
+			std::cerr << "Failed to parse OBJ '" << filepath << "': " << chunks[i].error << std::endl;
+			return false;
+		}
+		positionBase[i] = positionCount;
+		texCoordBase[i] = texCoordCount;
+		normalBase[i] = normalCount;
+		cornerBase[i] = cornerCount;
+		positionCount += chunks[i].positions.size() / 3;
+		texCoordCount += chunks[i].texCoords.size() / 2;
+		normalCount += chunks[i].normals.size() / 3;
+		cornerCount += chunks[i].corners.size() / 3;
+	}
+
+	// Resolve every corner to 0-based indices into the merged arrays, UINT_MAX for missing ones
+	const unsigned int MISSING = 0xFFFFFFFF;
+	std::vector<unsigned int> corners(cornerCount * 3);
+	std::vector<float> positions(positionCount * 3), colors(positionCount * 3), texCoords(texCoordCount * 2), normals(normalCount * 3);
+	std::atomic<bool> outOfRange(false);
+	ParallelFor(chunkCount, cornerCount, OBJ_MIN_PARALLEL_ITEMS, [&](unsigned int i) {
+		const ObjChunk& chunk = chunks[i];
+		std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + positionBase[i] * 3);
+		std::copy(chunk.colors.begin(), chunk.colors.end(), colors.begin() + positionBase[i] * 3);
+		std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + texCoordBase[i] * 2);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + normalBase[i] * 3);
+
+		const size_t bases[3] = { positionBase[i], texCoordBase[i], normalBase[i] };
+		const size_t counts[3] = { positionCount, texCoordCount, normalCount };
+		unsigned int* output = corners.data() + cornerBase[i] * 3;
+		for (size_t c = 0; c < chunk.corners.size(); c++) {
+			int stored = chunk.corners[c];
+			int slot = (int)(c % 3);
+			if (stored == OBJ_MISSING_INDEX) {
+				output[c] = MISSING;
+				continue;
+			}
+			long long index = stored > 0 ? (long long)stored - 1 : (long long)bases[slot] + stored + OBJ_RELATIVE_BIAS;
+			if (index < 0 || index >= (long long)counts[slot]) {
+				outOfRange = true;
+				index = 0;
+			}
+			output[c] = (unsigned int)index;
+		}
+	});
+	if (outOfRange) {
+		std::cerr << "Failed to parse OBJ '" << filepath << "': face index out of range" << std::endl;
+		return false;
+	}
+	chunks.clear();
+
+	// One vertex per distinct (v, vt, vn). Candidates are chained per position, and faces
+	// reference nearby positions, so the lookups stay in cache unlike a global hash table
+	std::vector<unsigned int> firstVertex(positionCount, MISSING);
+	std::vector<unsigned int> nextVertex;
+	std::vector<unsigned int> vertexCorners; // (v, vt, vn) of each output vertex
+	nextVertex.reserve(positionCount);
+	vertexCorners.reserve(positionCount * 3);
+	mesh.indices.resize(cornerCount);
+
+	for (size_t c = 0; c < cornerCount; c++) {
+		const unsigned int* corner = corners.data() + c * 3;
+		unsigned int vertex = firstVertex[corner[0]];
+		while (vertex != MISSING && (vertexCorners[vertex * 3 + 1] != corner[1] || vertexCorners[vertex * 3 + 2] != corner[2])) {
+			vertex = nextVertex[vertex];
+		}
+		if (vertex == MISSING) {
+			vertex = (unsigned int)nextVertex.size();
+			nextVertex.push_back(firstVertex[corner[0]]);
+			firstVertex[corner[0]] = vertex;
+			vertexCorners.insert(vertexCorners.end(), corner, corner + 3);
+		}
+		mesh.indices[c] = vertex;
+	}
+
+	mesh.layout = layout;
+	mesh.vertexCount = (unsigned int)nextVertex.size();
+	const unsigned int stride = layout.GetStride();
+	mesh.vertices.resize((size_t)mesh.vertexCount * stride);
+
+	std::vector<unsigned int> offsets;
+	unsigned int offset = 0;
+	for (const VertexBufferElement& element : elements) {
+		offsets.push_back(offset);
+		offset += element.GetSize();
+	}
+
+	// Interleave in parallel, every thread writes its own range of vertices
+	ParallelFor(threadCount, mesh.vertexCount, OBJ_MIN_PARALLEL_ITEMS, [&](unsigned int t) {
+		const unsigned int first = (unsigned int)((size_t)mesh.vertexCount * t / threadCount);
+		const unsigned int last = (unsigned int)((size_t)mesh.vertexCount * (t + 1) / threadCount);
+		for (unsigned int v = first; v < last; v++) {
+			const unsigned int* corner = vertexCorners.data() + (size_t)v * 3;
+			unsigned char* destination = mesh.vertices.data() + (size_t)v * stride;
+			for (size_t e = 0; e < elements.size(); e++) {
+				const float* source = nullptr;
+				unsigned int count = 0;
+				switch (attributes[e]) {
+					case MeshAttribute::Position: source = &positions[(size_t)corner[0] * 3]; count = 3; break;
+					case MeshAttribute::Color:    source = &colors[(size_t)corner[0] * 3]; count = 3; break;
+					case MeshAttribute::TexCoord: if (corner[1] != MISSING) { source = &texCoords[(size_t)corner[1] * 2]; count = 2; } break;
+					case MeshAttribute::Normal:   if (corner[2] != MISSING) { source = &normals[(size_t)corner[2] * 3]; count = 3; } break;
+				}
+				WriteVertexElement(destination + offsets[e], elements[e], source, count);
+			}
+		}
+	});
+
+	if (options.optimize) {
+		mesh.optimization = OptimizeMeshData(mesh, attributes);
+	}
+	return true;
+}
\ No newline at end of file
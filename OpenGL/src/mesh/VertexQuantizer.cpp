@@ -0,0 +1,125 @@
+#include "VertexQuantizer.h"
+
+#include <cstring>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/packing.hpp"
+
+// Components actually stored for an attribute after padding to a 4-byte boundary
+static unsigned int GetStoredCount(const QuantizedAttribute& attribute) {
+	switch (attribute.format) {
+		case VertexFormat::Half:
+		case VertexFormat::SNorm16:
+		case VertexFormat::UNorm16:       return (attribute.count + 1) & ~1u;
+		case VertexFormat::UNorm8:        return 4;
+		case VertexFormat::Packed1010102: return 4;
+		default:                          return attribute.count;
+	}
+}
+
+static void PushAttribute(VertexBufferLayout& layout, const QuantizedAttribute& attribute) {
+	unsigned int count = GetStoredCount(attribute);
+	switch (attribute.format) {
+		case VertexFormat::Float:         layout.Push<float>(count); break;
+		case VertexFormat::Half:          layout.Push<Half>(count); break;
+		case VertexFormat::SNorm16:       layout.Push<short>(count); break;
+		case VertexFormat::UNorm16:       layout.Push<unsigned short>(count); break;
+		case VertexFormat::UNorm8:        layout.Push<unsigned char>(count); break;
+		case VertexFormat::Packed1010102: layout.Push<::Packed1010102>(count); break;
+	}
+}
+
+void WriteVertexElement(unsigned char* destination, const VertexBufferElement& element, const float* values, unsigned int count) {
+	ASSERT(element.count <= 4);
+	// Components the source does not have default to (0, 0, 0, 1) like GL does
+	float v[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	for (unsigned int c = 0; c < count && c < 4; c++) {
+		v[c] = values[c];
+	}
+	const bool normalized = element.normalized == GL_TRUE;
+
+	switch (element.type) {
+		case GL_FLOAT:
+			memcpy(destination, v, element.count * sizeof(float));
+			break;
+		case GL_HALF_FLOAT:
+			for (unsigned int c = 0; c < element.count; c++) {
+				unsigned short packed = glm::packHalf1x16(v[c]);
+				memcpy(destination + c * sizeof(packed), &packed, sizeof(packed));
+			}
+			break;
+		case GL_SHORT:
+			for (unsigned int c = 0; c < element.count; c++) {
+				short packed = normalized ? (short)glm::packSnorm1x16(v[c]) : (short)v[c];
+				memcpy(destination + c * sizeof(packed), &packed, sizeof(packed));
+			}
+			break;
+		case GL_UNSIGNED_SHORT:
+			for (unsigned int c = 0; c < element.count; c++) {
+				unsigned short packed = normalized ? glm::packUnorm1x16(v[c]) : (unsigned short)v[c];
+				memcpy(destination + c * sizeof(packed), &packed, sizeof(packed));
+			}
+			break;
+		case GL_BYTE:
+			for (unsigned int c = 0; c < element.count; c++) {
+				destination[c] = normalized ? glm::packSnorm1x8(v[c]) : (unsigned char)(signed char)v[c];
+			}
+			break;
+		case GL_UNSIGNED_BYTE:
+			for (unsigned int c = 0; c < element.count; c++) {
+				destination[c] = normalized ? glm::packUnorm1x8(v[c]) : (unsigned char)v[c];
+			}
+			break;
+		case GL_INT:
+			for (unsigned int c = 0; c < element.count; c++) {
+				int packed = (int)v[c];
+				memcpy(destination + c * sizeof(packed), &packed, sizeof(packed));
+			}
+			break;
+		case GL_UNSIGNED_INT:
+			for (unsigned int c = 0; c < element.count; c++) {
+				unsigned int packed = (unsigned int)v[c];
+				memcpy(destination + c * sizeof(packed), &packed, sizeof(packed));
+			}
+			break;
+		case GL_INT_2_10_10_10_REV: {
+			unsigned int packed = glm::packSnorm3x10_1x2(glm::vec4(v[0], v[1], v[2], v[3]));
+			memcpy(destination, &packed, sizeof(packed));
+			break;
+		}
+		case GL_UNSIGNED_INT_2_10_10_10_REV: {
+			unsigned int packed = glm::packUnorm3x10_1x2(glm::vec4(v[0], v[1], v[2], v[3]));
+			memcpy(destination, &packed, sizeof(packed));
+			break;
+		}
+		default:
+			ASSERT(false); // Unsupported element type
+	}
+}
+
+QuantizedMesh QuantizeVertices(const float* vertices, unsigned int vertexCount, const std::vector<QuantizedAttribute>& attributes) {
+	QuantizedMesh mesh;
+	unsigned int sourceStride = 0; // In floats
+	for (const QuantizedAttribute& attribute : attributes) {
+		ASSERT(attribute.count <= 4); // Vertex attributes have at most 4 components
+		PushAttribute(mesh.layout, attribute);
+		sourceStride += attribute.count;
+	}
+
+	const std::vector<VertexBufferElement>& elements = mesh.layout.GetElements();
+	const unsigned int stride = mesh.layout.GetStride();
+	mesh.vertices.resize((size_t)vertexCount * stride);
+
+	for (unsigned int v = 0; v < vertexCount; v++) {
+		const float* source = vertices + (size_t)v * sourceStride;
+		unsigned char* destination = mesh.vertices.data() + (size_t)v * stride;
+		for (size_t a = 0; a < attributes.size(); a++) {
+			// Padding components come out as (0, 0, 0, 1)
+			WriteVertexElement(destination, elements[a], source, attributes[a].count);
+			destination += elements[a].GetSize();
+			source += attributes[a].count;
+		}
+	}
+
+	return mesh;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "../buffers/VertexBufferLayout.h"
+
+// Storage format the quantizer converts a float attribute to
+enum class VertexFormat {
+	Float, // 4 bytes per component, unchanged
+	Half, // 2 bytes per component, GL_HALF_FLOAT. Positions and UVs
+	SNorm16, // 2 bytes per component, [-1, 1]. Positions remapped by the caller, tangents
+	UNorm16, // 2 bytes per component, [0, 1]. UVs in a single atlas
+	UNorm8, // 1 byte per component, [0, 1]. Colors
+	Packed1010102 // 4 bytes for xyz + w, signed normalized. Normals and tangents (w = handedness)
+};
+
+struct QuantizedAttribute {
+	unsigned int count; // Float components per vertex in the source data
+	VertexFormat format;
+};
+
+// Result of QuantizeVertices: ready for a VertexBuffer plus the matching layout
+struct QuantizedMesh {
+	std::vector<unsigned char> vertices;
+	VertexBufferLayout layout;
+};
+
+// Converts one attribute value (up to 4 components) to the element's format at destination.
+// The loaders write their layouts through it, QuantizeVertices its own.
+void WriteVertexElement(unsigned char* destination, const VertexBufferElement& element, const float* values, unsigned int count);
+
+// Converts interleaved float vertices (the attributes back to back, in order) into the
+// requested compact formats. 2-byte formats with an odd count and 1-byte formats are padded
+// to 4 bytes so every attribute stays 4-byte aligned, the extra components read as 0 / 1.
+// Normalized formats clamp, values outside their range must be remapped beforehand.
+QuantizedMesh QuantizeVertices(const float* vertices, unsigned int vertexCount, const std::vector<QuantizedAttribute>& attributes);
\ No newline at end of file
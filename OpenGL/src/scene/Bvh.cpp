@@ -0,0 +1,403 @@
+#include "Bvh.h"
+#include "FrustumCuller.h"
+#include "../Renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+static const unsigned int BVH_BIN_COUNT = 16;
+static const unsigned int BVH_MAX_LEAF_SIZE = 8;
+static const unsigned int BVH_PARALLEL_MIN_OBJECTS = 16384; // Smaller subtrees aren't worth a thread
+static const unsigned int BVH_NO_PARENT = 0xFFFFFFFF;
+
+struct BvhBuildContext {
+	const glm::vec3* min;
+	const glm::vec3* max;
+	const glm::vec3* centroid;
+	unsigned int* objects;
+};
+
+static inline float HalfArea(const glm::vec3& min, const glm::vec3& max) {
+	const glm::vec3 size = max - min;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+// Builds the subtree over objects[first, first + count) into nodes. Indices stored in the nodes
+// are relative to where the subtree starts in nodes, so subtrees built on other threads into
+// their own arrays can be appended with an offset.
+static void BuildNode(const BvhBuildContext& context, std::vector<BvhNode>& nodes, unsigned int base,
+	unsigned int first, unsigned int count, unsigned int parallelDepth) {
+	const unsigned int nodeIndex = (unsigned int)nodes.size();
+	nodes.push_back(BvhNode());
+
+	glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+	glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+	for (unsigned int i = first; i < first + count; i++) {
+		const unsigned int object = context.objects[i];
+		boundsMin = glm::min(boundsMin, context.min[object]);
+		boundsMax = glm::max(boundsMax, context.max[object]);
+		centroidMin = glm::min(centroidMin, context.centroid[object]);
+		centroidMax = glm::max(centroidMax, context.centroid[object]);
+	}
+	nodes[nodeIndex].min = boundsMin;
+	nodes[nodeIndex].max = boundsMax;
+
+	// Best split over binned centroids on every axis, cost relative to intersecting every object
+	int bestAxis = -1;
+	unsigned int bestBin = 0;
+	float bestCost = FLT_MAX;
+	if (count > 1) {
+		// One pass over the objects fills the bins of all three axes
+		glm::vec3 binMin[3][BVH_BIN_COUNT], binMax[3][BVH_BIN_COUNT];
+		unsigned int binCount[3][BVH_BIN_COUNT] = {};
+		for (int axis = 0; axis < 3; axis++) {
+			for (unsigned int b = 0; b < BVH_BIN_COUNT; b++) {
+				binMin[axis][b] = glm::vec3(FLT_MAX);
+				binMax[axis][b] = glm::vec3(-FLT_MAX);
+			}
+		}
+		const glm::vec3 extent = centroidMax - centroidMin;
+		const glm::vec3 scale(extent.x > 0.0f ? BVH_BIN_COUNT / extent.x : 0.0f,
+			extent.y > 0.0f ? BVH_BIN_COUNT / extent.y : 0.0f, extent.z > 0.0f ? BVH_BIN_COUNT / extent.z : 0.0f);
+		for (unsigned int i = first; i < first + count; i++) {
+			const unsigned int object = context.objects[i];
+			const glm::vec3 offset = (context.centroid[object] - centroidMin) * scale;
+			for (int axis = 0; axis < 3; axis++) {
+				const unsigned int b = std::min(BVH_BIN_COUNT - 1, (unsigned int)offset[axis]);
+				binMin[axis][b] = glm::min(binMin[axis][b], context.min[object]);
+				binMax[axis][b] = glm::max(binMax[axis][b], context.max[object]);
+				binCount[axis][b]++;
+			}
+		}
+
+		const float area = HalfArea(boundsMin, boundsMax);
+		for (int axis = 0; axis < 3; axis++) {
+			if (extent[axis] <= 0.0f) {
+				continue;
+			}
+
+			// Sweep from the right for the right side's area, then from the left to evaluate
+			float rightCost[BVH_BIN_COUNT];
+			glm::vec3 sweepMin(FLT_MAX), sweepMax(-FLT_MAX);
+			unsigned int sweepCount = 0;
+			for (unsigned int b = BVH_BIN_COUNT - 1; b > 0; b--) {
+				sweepMin = glm::min(sweepMin, binMin[axis][b]);
+				sweepMax = glm::max(sweepMax, binMax[axis][b]);
+				sweepCount += binCount[axis][b];
+				rightCost[b] = sweepCount ? HalfArea(sweepMin, sweepMax) * sweepCount : -1.0f;
+			}
+			sweepMin = glm::vec3(FLT_MAX);
+			sweepMax = glm::vec3(-FLT_MAX);
+			sweepCount = 0;
+			for (unsigned int b = 0; b + 1 < BVH_BIN_COUNT; b++) {
+				sweepMin = glm::min(sweepMin, binMin[axis][b]);
+				sweepMax = glm::max(sweepMax, binMax[axis][b]);
+				sweepCount += binCount[axis][b];
+				if (sweepCount == 0 || rightCost[b + 1] < 0.0f) {
+					continue; // One side would be empty
+				}
+				const float cost = 1.0f + (HalfArea(sweepMin, sweepMax) * sweepCount + rightCost[b + 1]) / area;
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = b;
+				}
+			}
+		}
+	}
+
+	const bool splitPays = bestAxis >= 0 && bestCost < (float)count;
+	if (count <= 1 || (count <= BVH_MAX_LEAF_SIZE && !splitPays)) {
+		nodes[nodeIndex].leftOrFirst = first;
+		nodes[nodeIndex].count = count;
+		return;
+	}
+
+	unsigned int middle = first;
+	if (bestAxis >= 0) {
+		const float scale = BVH_BIN_COUNT / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+		const float axisMin = centroidMin[bestAxis];
+		const int axis = bestAxis;
+		unsigned int* split = std::partition(context.objects + first, context.objects + first + count, [&](unsigned int object) {
+			return std::min(BVH_BIN_COUNT - 1, (unsigned int)((context.centroid[object][axis] - axisMin) * scale)) <= bestBin;
+		});
+		middle = (unsigned int)(split - context.objects);
+	}
+	if (bestAxis < 0 || middle == first || middle == first + count) {
+		middle = first + count / 2; // Every centroid is the same point, any split is as good
+	}
+
+	unsigned int right;
+	if (parallelDepth > 0 && count >= BVH_PARALLEL_MIN_OBJECTS) {
+		// The halves own disjoint ranges of objects, build the left one on another thread
+		std::vector<BvhNode> leftNodes, rightNodes;
+		std::thread left([&]() { BuildNode(context, leftNodes, 0, first, middle - first, parallelDepth - 1); });
+		BuildNode(context, rightNodes, 0, middle, first + count - middle, parallelDepth - 1);
+		left.join();
+
+		for (const std::vector<BvhNode>* subtree : { &leftNodes, &rightNodes }) {
+			const unsigned int offset = (unsigned int)nodes.size() - base;
+			for (BvhNode node : *subtree) {
+				if (node.count == 0) {
+					node.leftOrFirst += offset;
+				}
+				nodes.push_back(node);
+			}
+		}
+		right = nodeIndex - base + 1 + (unsigned int)leftNodes.size();
+	}
+	else {
+		BuildNode(context, nodes, base, first, middle - first, 0);
+		right = (unsigned int)nodes.size() - base;
+		BuildNode(context, nodes, base, middle, first + count - middle, 0);
+	}
+	nodes[nodeIndex].leftOrFirst = right;
+	nodes[nodeIndex].count = 0;
+}
+
+void Bvh::Build(const glm::vec3* min, const glm::vec3* max, unsigned int count, unsigned int threadCount) {
+	m_Min.assign(min, min + count);
+	m_Max.assign(max, max + count);
+	m_Objects.resize(count);
+	m_Nodes.clear();
+	m_Queued.assign(count, 0);
+	m_Dirty.clear();
+	if (count == 0) {
+		m_Parent.clear();
+		m_Leaf.clear();
+		return;
+	}
+
+	std::vector<glm::vec3> centroids(count);
+	for (unsigned int i = 0; i < count; i++) {
+		m_Objects[i] = i;
+		centroids[i] = (min[i] + max[i]) * 0.5f;
+	}
+
+	// Enough levels of two-way splits to give every thread a subtree
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	unsigned int parallelDepth = 0;
+	while ((1u << parallelDepth) < threadCount) {
+		parallelDepth++;
+	}
+
+	BvhBuildContext context = { min, max, centroids.data(), m_Objects.data() };
+	m_Nodes.reserve(2 * count); // A binary tree never has more nodes than that
+	BuildNode(context, m_Nodes, 0, 0, count, parallelDepth);
+
+	m_Parent.assign(m_Nodes.size(), BVH_NO_PARENT);
+	m_Leaf.resize(count);
+	for (unsigned int n = 0; n < (unsigned int)m_Nodes.size(); n++) {
+		const BvhNode& node = m_Nodes[n];
+		if (node.count == 0) {
+			m_Parent[n + 1] = n;
+			m_Parent[node.leftOrFirst] = n;
+		}
+		else {
+			for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+				m_Leaf[m_Objects[i]] = n;
+			}
+		}
+	}
+}
+
+void Bvh::SetBounds(unsigned int object, const glm::vec3& min, const glm::vec3& max) {
+	m_Min[object] = min;
+	m_Max[object] = max;
+	if (!m_Queued[object]) {
+		m_Queued[object] = 1;
+		m_Dirty.push_back(object);
+	}
+}
+
+unsigned int Bvh::Refit() {
+	if (m_Dirty.empty()) {
+		return 0;
+	}
+	for (unsigned int object : m_Dirty) {
+		m_Queued[object] = 0;
+	}
+
+	// Children come after their parent, so one backwards pass sees every child before its parent
+	if (m_Dirty.size() * 4 > m_Min.size()) {
+		m_Dirty.clear();
+		for (unsigned int n = (unsigned int)m_Nodes.size(); n-- > 0;) {
+			BvhNode& node = m_Nodes[n];
+			if (node.count == 0) {
+				node.min = glm::min(m_Nodes[n + 1].min, m_Nodes[node.leftOrFirst].min);
+				node.max = glm::max(m_Nodes[n + 1].max, m_Nodes[node.leftOrFirst].max);
+			}
+			else {
+				node.min = glm::vec3(FLT_MAX);
+				node.max = glm::vec3(-FLT_MAX);
+				for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+					node.min = glm::min(node.min, m_Min[m_Objects[i]]);
+					node.max = glm::max(node.max, m_Max[m_Objects[i]]);
+				}
+			}
+		}
+		return (unsigned int)m_Nodes.size();
+	}
+
+	// Few objects moved, walk up from each one's leaf until a node's box stops changing
+	unsigned int updated = 0;
+	for (unsigned int object : m_Dirty) {
+		unsigned int n = m_Leaf[object];
+		BvhNode& leaf = m_Nodes[n];
+		leaf.min = glm::vec3(FLT_MAX);
+		leaf.max = glm::vec3(-FLT_MAX);
+		for (unsigned int i = leaf.leftOrFirst; i < leaf.leftOrFirst + leaf.count; i++) {
+			leaf.min = glm::min(leaf.min, m_Min[m_Objects[i]]);
+			leaf.max = glm::max(leaf.max, m_Max[m_Objects[i]]);
+		}
+		updated++;
+
+		for (n = m_Parent[n]; n != BVH_NO_PARENT; n = m_Parent[n]) {
+			BvhNode& node = m_Nodes[n];
+			const glm::vec3 min = glm::min(m_Nodes[n + 1].min, m_Nodes[node.leftOrFirst].min);
+			const glm::vec3 max = glm::max(m_Nodes[n + 1].max, m_Nodes[node.leftOrFirst].max);
+			if (min == node.min && max == node.max) {
+				break;
+			}
+			node.min = min;
+			node.max = max;
+			updated++;
+		}
+	}
+	m_Dirty.clear();
+	return updated;
+}
+
+// Clears the bits of planes the box is completely inside, returns false when it is outside one
+static inline bool ClassifyBox(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max, unsigned int& planeMask) {
+	const glm::vec3 center = (min + max) * 0.5f;
+	const glm::vec3 extent = (max - min) * 0.5f;
+	for (unsigned int p = 0; p < 6; p++) {
+		if (!(planeMask & (1u << p))) {
+			continue;
+		}
+		const glm::vec4& plane = frustum.planes[p];
+		const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+		const float radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+		if (distance < -radius) {
+			return false;
+		}
+		if (distance >= radius) {
+			planeMask &= ~(1u << p);
+		}
+	}
+	return true;
+}
+
+unsigned int Bvh::QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& visible) const {
+	if (m_Nodes.empty()) {
+		return 0;
+	}
+	const size_t start = visible.size();
+
+	// Children of a box fully inside a plane are inside it too and skip that test
+	struct Entry {
+		unsigned int node;
+		unsigned int planeMask;
+	};
+	std::vector<Entry> stack;
+	stack.reserve(64);
+	stack.push_back({ 0, 0x3F });
+	while (!stack.empty()) {
+		Entry entry = stack.back();
+		stack.pop_back();
+		const BvhNode& node = m_Nodes[entry.node];
+		if (entry.planeMask && !ClassifyBox(frustum, node.min, node.max, entry.planeMask)) {
+			continue;
+		}
+		if (node.count == 0) {
+			stack.push_back({ node.leftOrFirst, entry.planeMask });
+			stack.push_back({ entry.node + 1, entry.planeMask });
+			continue;
+		}
+		for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+			const unsigned int object = m_Objects[i];
+			unsigned int planeMask = entry.planeMask;
+			if (!planeMask || ClassifyBox(frustum, m_Min[object], m_Max[object], planeMask)) {
+				visible.push_back(object);
+			}
+		}
+	}
+	return (unsigned int)(visible.size() - start);
+}
+
+// Slab test, distance to where the ray enters the box (0 when it starts inside) or FLT_MAX on a miss
+static inline float IntersectBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& min, const glm::vec3& max, float maxDistance) {
+	const glm::vec3 t0 = (min - origin) * inverseDirection;
+	const glm::vec3 t1 = (max - origin) * inverseDirection;
+	const glm::vec3 entries = glm::min(t0, t1);
+	const glm::vec3 exits = glm::max(t0, t1);
+	const float enter = std::max(std::max(entries.x, entries.y), std::max(entries.z, 0.0f));
+	const float leave = std::min(std::min(exits.x, exits.y), std::min(exits.z, maxDistance));
+	return enter <= leave ? enter : FLT_MAX;
+}
+
+bool Bvh::Raycast(const glm::vec3& origin, const glm::vec3& direction, BvhRayHit& hit, float maxDistance) const {
+	if (m_Nodes.empty()) {
+		return false;
+	}
+	const glm::vec3 inverseDirection = 1.0f / direction;
+	hit.object = 0xFFFFFFFF;
+	hit.distance = maxDistance;
+
+	struct Entry {
+		unsigned int node;
+		float distance;
+	};
+	std::vector<Entry> stack;
+	stack.reserve(64);
+	const float rootDistance = IntersectBox(origin, inverseDirection, m_Nodes[0].min, m_Nodes[0].max, maxDistance);
+	if (rootDistance != FLT_MAX) {
+		stack.push_back({ 0, rootDistance });
+	}
+	while (!stack.empty()) {
+		Entry entry = stack.back();
+		stack.pop_back();
+		if (entry.distance > hit.distance) {
+			continue; // Something nearer was found since this was pushed
+		}
+		const BvhNode& node = m_Nodes[entry.node];
+		if (node.count == 0) {
+			// Visit the nearer child first so the hit distance prunes the other one
+			Entry left = { entry.node + 1, IntersectBox(origin, inverseDirection, m_Nodes[entry.node + 1].min, m_Nodes[entry.node + 1].max, hit.distance) };
+			Entry right = { node.leftOrFirst, IntersectBox(origin, inverseDirection, m_Nodes[node.leftOrFirst].min, m_Nodes[node.leftOrFirst].max, hit.distance) };
+			if (left.distance > right.distance) {
+				std::swap(left, right);
+			}
+			if (right.distance != FLT_MAX) {
+				stack.push_back(right);
+			}
+			if (left.distance != FLT_MAX) {
+				stack.push_back(left);
+			}
+			continue;
+		}
+		for (unsigned int i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++) {
+			const unsigned int object = m_Objects[i];
+			const float distance = IntersectBox(origin, inverseDirection, m_Min[object], m_Max[object], hit.distance);
+			if (distance != FLT_MAX && (distance < hit.distance || hit.object == 0xFFFFFFFF)) {
+				hit.object = object;
+				hit.distance = distance;
+			}
+		}
+	}
+	return hit.object != 0xFFFFFFFF;
+}
+
+void GetPickRay(const glm::mat4& viewProjection, const glm::vec2& cursor, const glm::vec2& viewportSize,
+	glm::vec3& origin, glm::vec3& direction) {
+	const glm::vec2 ndc(cursor.x / viewportSize.x * 2.0f - 1.0f, 1.0f - cursor.y / viewportSize.y * 2.0f);
+	const glm::mat4 inverse = glm::inverse(viewProjection);
+	const glm::vec4 nearPoint = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+	const glm::vec4 farPoint = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+	origin = glm::vec3(nearPoint) / nearPoint.w;
+	direction = glm::vec3(farPoint) / farPoint.w - origin;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cfloat>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct Frustum;
+
+// 32 bytes, two per cache line. Nodes are stored depth first: an interior node's left child
+// is the next node and leftOrFirst holds its right child, a leaf's objects are
+// Bvh::GetObjects()[leftOrFirst, leftOrFirst + count).
+struct BvhNode {
+	glm::vec3 min;
+	unsigned int leftOrFirst;
+	glm::vec3 max;
+	unsigned int count; // 0 for interior nodes
+};
+
+struct BvhRayHit {
+	unsigned int object;
+	float distance; // Along the ray direction, in its units
+};
+
+// Bounding volume hierarchy over world-space object boxes, built with the surface area
+// heuristic (binned) and flattened into one array. Meant for large, mostly static scenes:
+// moving objects update their box and Refit() grows the tree around them without changing
+// its topology, so rebuild once objects have travelled far from where they were built.
+class Bvh {
+private:
+	std::vector<BvhNode> m_Nodes;
+	std::vector<unsigned int> m_Objects; // Object indices in leaf order
+	std::vector<glm::vec3> m_Min, m_Max; // Per object
+	std::vector<unsigned int> m_Parent; // Per node, 0xFFFFFFFF for the root
+	std::vector<unsigned int> m_Leaf; // Per object, the leaf holding it
+	std::vector<unsigned char> m_Queued; // Per object, set while the object is in m_Dirty
+	std::vector<unsigned int> m_Dirty;
+public:
+	Bvh() = default;
+
+	// Builds over count boxes, object i is min[i], max[i]. Large scenes build their subtrees
+	// on up to threadCount threads, 0 uses every hardware thread.
+	void Build(const glm::vec3* min, const glm::vec3* max, unsigned int count, unsigned int threadCount = 0);
+
+	void SetBounds(unsigned int object, const glm::vec3& min, const glm::vec3& max); // Takes effect at the next Refit
+	unsigned int Refit(); // Returns how many nodes were updated
+
+	// Appends every object whose box is at least partly inside, returns how many were appended
+	unsigned int QueryFrustum(const Frustum& frustum, std::vector<unsigned int>& visible) const;
+
+	// Nearest object whose box the ray hits within maxDistance, direction need not be normalized
+	bool Raycast(const glm::vec3& origin, const glm::vec3& direction, BvhRayHit& hit, float maxDistance = FLT_MAX) const;
+
+	inline const std::vector<BvhNode>& GetNodes() const { return m_Nodes; }
+	inline const std::vector<unsigned int>& GetObjects() const { return m_Objects; }
+	inline unsigned int GetObjectCount() const { return (unsigned int)m_Min.size(); }
+};
+
+// World-space ray through a cursor position given in window pixels with the origin top left,
+// as GLFW and ImGui report it. Works for perspective and orthographic projections.
+void GetPickRay(const glm::mat4& viewProjection, const glm::vec2& cursor, const glm::vec2& viewportSize,
+	glm::vec3& origin, glm::vec3& direction);
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "FrustumCuller.h"
+#include "../Renderer.h"
+
+#include <cmath>
+
+// Same targets as the TransformSystem kernels
+#if defined(__AVX__)
+#define CULL_SIMD_AVX
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULL_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+Frustum ExtractFrustum(const glm::mat4& viewProjection) {
+	// glm is column-major, row r of the matrix is (m[0][r], m[1][r], m[2][r], m[3][r])
+	const glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	const glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	const glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	const glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	Frustum frustum;
+	frustum.planes[0] = row3 + row0;
+	frustum.planes[1] = row3 - row0;
+	frustum.planes[2] = row3 + row1;
+	frustum.planes[3] = row3 - row1;
+	frustum.planes[4] = row3 + row2;
+	frustum.planes[5] = row3 - row2;
+	for (glm::vec4& plane : frustum.planes) {
+		plane /= glm::length(glm::vec3(plane)); // So the distance compares against a radius
+	}
+	return frustum;
+}
+
+unsigned int FrustumCuller::AddSphere(const glm::vec3& center, float radius) {
+	m_CenterX.push_back(center.x);
+	m_CenterY.push_back(center.y);
+	m_CenterZ.push_back(center.z);
+	m_ExtentX.push_back(radius);
+	m_ExtentY.push_back(radius);
+	m_ExtentZ.push_back(radius);
+	m_Radius.push_back(radius);
+	return GetCount() - 1;
+}
+
+unsigned int FrustumCuller::AddBox(const glm::vec3& min, const glm::vec3& max) {
+	AddSphere(glm::vec3(0.0f), 0.0f);
+	SetBox(GetCount() - 1, min, max);
+	return GetCount() - 1;
+}
+
+void FrustumCuller::SetSphere(unsigned int index, const glm::vec3& center, float radius) {
+	m_CenterX[index] = center.x;
+	m_CenterY[index] = center.y;
+	m_CenterZ[index] = center.z;
+	m_ExtentX[index] = radius; // The box around the sphere never wins over it
+	m_ExtentY[index] = radius;
+	m_ExtentZ[index] = radius;
+	m_Radius[index] = radius;
+}
+
+void FrustumCuller::SetBox(unsigned int index, const glm::vec3& min, const glm::vec3& max) {
+	const glm::vec3 center = (min + max) * 0.5f;
+	const glm::vec3 extent = (max - min) * 0.5f;
+	m_CenterX[index] = center.x;
+	m_CenterY[index] = center.y;
+	m_CenterZ[index] = center.z;
+	m_ExtentX[index] = extent.x;
+	m_ExtentY[index] = extent.y;
+	m_ExtentZ[index] = extent.z;
+	m_Radius[index] = glm::length(extent); // The sphere around the box never wins over it
+}
+
+void FrustumCuller::RemoveSwap(unsigned int index) {
+	ASSERT(index < GetCount());
+	for (std::vector<float>* array : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius }) {
+		(*array)[index] = array->back();
+		array->pop_back();
+	}
+}
+
+void FrustumCuller::Reserve(unsigned int count) {
+	for (std::vector<float>* array : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius }) {
+		array->reserve(count);
+	}
+}
+
+void FrustumCuller::Clear() {
+	for (std::vector<float>* array : { &m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius }) {
+		array->clear();
+	}
+}
+
+unsigned int FrustumCuller::Cull(const glm::mat4& viewProjection, std::vector<unsigned int>& visible) {
+	return Cull(ExtractFrustum(viewProjection), visible);
+}
+
+unsigned int FrustumCuller::CullScalar(const Frustum& frustum, std::vector<unsigned int>& visible, unsigned int first, unsigned int count) const {
+	unsigned int appended = 0;
+	for (unsigned int o = first; o < first + count; o++) {
+		bool outside = false;
+		for (const glm::vec4& plane : frustum.planes) {
+			const float distance = plane.x * m_CenterX[o] + plane.y * m_CenterY[o] + plane.z * m_CenterZ[o] + plane.w;
+			const float boxRadius = std::fabs(plane.x) * m_ExtentX[o] + std::fabs(plane.y) * m_ExtentY[o] + std::fabs(plane.z) * m_ExtentZ[o];
+			const float radius = boxRadius < m_Radius[o] ? boxRadius : m_Radius[o];
+			outside |= distance < -radius;
+		}
+		if (!outside) {
+			visible.push_back(o);
+			appended++;
+		}
+	}
+	return appended;
+}
+
+#if defined(CULL_SIMD_AVX) || defined(CULL_SIMD_SSE)
+
+// Thin wrappers so one kernel serves both register widths
+#if defined(CULL_SIMD_AVX)
+struct CullLanes {
+	typedef __m256 Vector;
+	static const unsigned int WIDTH = 8;
+	static inline Vector Load(const float* p) { return _mm256_loadu_ps(p); }
+	static inline Vector Set1(float value) { return _mm256_set1_ps(value); }
+	static inline Vector Zero() { return _mm256_setzero_ps(); }
+	static inline Vector Add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+	static inline Vector Sub(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+	static inline Vector Mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+	static inline Vector Min(Vector a, Vector b) { return _mm256_min_ps(a, b); }
+	static inline Vector Or(Vector a, Vector b) { return _mm256_or_ps(a, b); }
+	static inline Vector Less(Vector a, Vector b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static inline unsigned int Mask(Vector a) { return (unsigned int)_mm256_movemask_ps(a); } // One bit per lane
+};
+#else
+struct CullLanes {
+	typedef __m128 Vector;
+	static const unsigned int WIDTH = 4;
+	static inline Vector Load(const float* p) { return _mm_loadu_ps(p); }
+	static inline Vector Set1(float value) { return _mm_set1_ps(value); }
+	static inline Vector Zero() { return _mm_setzero_ps(); }
+	static inline Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+	static inline Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+	static inline Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+	static inline Vector Min(Vector a, Vector b) { return _mm_min_ps(a, b); }
+	static inline Vector Or(Vector a, Vector b) { return _mm_or_ps(a, b); }
+	static inline Vector Less(Vector a, Vector b) { return _mm_cmplt_ps(a, b); }
+	static inline unsigned int Mask(Vector a) { return (unsigned int)_mm_movemask_ps(a); } // One bit per lane
+};
+#endif
+
+unsigned int FrustumCuller::Cull(const Frustum& frustum, std::vector<unsigned int>& visible) {
+	typedef CullLanes S;
+	typedef S::Vector V;
+	const unsigned int count = GetCount();
+	const size_t start = visible.size();
+	visible.resize(start + count); // Worst case, trimmed below
+	unsigned int* out = visible.data() + start;
+	unsigned int appended = 0;
+
+	// Every object shares the planes, broadcast each component once
+	V planeX[6], planeY[6], planeZ[6], planeW[6], absX[6], absY[6], absZ[6];
+	for (int p = 0; p < 6; p++) {
+		const glm::vec4& plane = frustum.planes[p];
+		planeX[p] = S::Set1(plane.x);
+		planeY[p] = S::Set1(plane.y);
+		planeZ[p] = S::Set1(plane.z);
+		planeW[p] = S::Set1(plane.w);
+		absX[p] = S::Set1(std::fabs(plane.x));
+		absY[p] = S::Set1(std::fabs(plane.y));
+		absZ[p] = S::Set1(std::fabs(plane.z));
+	}
+	const V zero = S::Zero();
+
+	unsigned int o = 0;
+	for (; o + S::WIDTH <= count; o += S::WIDTH) {
+		const V cx = S::Load(&m_CenterX[o]), cy = S::Load(&m_CenterY[o]), cz = S::Load(&m_CenterZ[o]);
+		const V ex = S::Load(&m_ExtentX[o]), ey = S::Load(&m_ExtentY[o]), ez = S::Load(&m_ExtentZ[o]);
+		const V radius = S::Load(&m_Radius[o]);
+
+		V outside = zero;
+		for (int p = 0; p < 6; p++) {
+			const V distance = S::Add(S::Add(S::Add(S::Mul(planeX[p], cx), S::Mul(planeY[p], cy)), S::Mul(planeZ[p], cz)), planeW[p]);
+			const V boxRadius = S::Add(S::Add(S::Mul(absX[p], ex), S::Mul(absY[p], ey)), S::Mul(absZ[p], ez));
+			outside = S::Or(outside, S::Less(distance, S::Sub(zero, S::Min(boxRadius, radius))));
+		}
+
+		// Write every lane and only advance past the visible ones, no branch per object
+		const unsigned int outsideMask = S::Mask(outside);
+		for (unsigned int lane = 0; lane < S::WIDTH; lane++) {
+			out[appended] = o + lane;
+			appended += ((outsideMask >> lane) & 1) ^ 1;
+		}
+	}
+	visible.resize(start + appended);
+
+	// Fewer objects than a register holds are left, finish them one by one
+	appended += CullScalar(frustum, visible, o, count - o);
+
+	m_Stats.tested = count;
+	m_Stats.visible = appended;
+	m_Stats.culled = count - appended;
+	return appended;
+}
+
+#else
+
+unsigned int FrustumCuller::Cull(const Frustum& frustum, std::vector<unsigned int>& visible) {
+	const unsigned int appended = CullScalar(frustum, visible, 0, GetCount()); // No SIMD on this target
+	m_Stats.tested = GetCount();
+	m_Stats.visible = appended;
+	m_Stats.culled = GetCount() - appended;
+	return appended;
+}
+
+#endif
+
+const char* FrustumCuller::GetKernelName() {
+#if defined(CULL_SIMD_AVX)
+	return "AVX";
+#elif defined(CULL_SIMD_SSE)
+	return "SSE";
+#else
+	return "Scalar";
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// Six planes (x, y, z) . p + w >= 0 inside, normalized, in the space viewProjection maps from
+struct Frustum {
+	glm::vec4 planes[6]; // Left, right, bottom, top, near, far
+};
+
+// Gribb and Hartmann extraction for GL clip space (-w <= z <= w)
+Frustum ExtractFrustum(const glm::mat4& viewProjection);
+
+struct CullStats {
+	unsigned int tested;
+	unsigned int visible;
+	unsigned int culled;
+};
+
+// World-space bounds of many objects in structure-of-arrays form, tested against the frustum
+// 4 (SSE) or 8 (AVX) objects at a time. Each object keeps a sphere and a box around the same
+// center and a plane uses whichever of the two is tighter along its normal, so objects added
+// as spheres test as spheres, boxes as boxes. Indices follow the same Add/RemoveSwap scheme as
+// TransformSystem, so one index can address both.
+class FrustumCuller {
+private:
+	std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+	std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ; // Half sizes of the box
+	std::vector<float> m_Radius;
+	CullStats m_Stats = { 0, 0, 0 };
+public:
+	FrustumCuller() = default;
+
+	unsigned int AddSphere(const glm::vec3& center, float radius); // Returns the object's index
+	unsigned int AddBox(const glm::vec3& min, const glm::vec3& max);
+	void SetSphere(unsigned int index, const glm::vec3& center, float radius);
+	void SetBox(unsigned int index, const glm::vec3& min, const glm::vec3& max);
+	void RemoveSwap(unsigned int index); // Moves the last object into index
+	void Reserve(unsigned int count);
+	void Clear();
+
+	// Appends the index of every object at least partly inside to visible, in index order,
+	// and returns how many were appended. Also updates GetStats.
+	unsigned int Cull(const glm::mat4& viewProjection, std::vector<unsigned int>& visible);
+	unsigned int Cull(const Frustum& frustum, std::vector<unsigned int>& visible);
+
+	// Same results one object at a time, the reference for the SIMD kernel and its tail
+	unsigned int CullScalar(const Frustum& frustum, std::vector<unsigned int>& visible, unsigned int first, unsigned int count) const;
+
+	inline const CullStats& GetStats() const { return m_Stats; } // Counts of the last Cull
+	inline unsigned int GetCount() const { return (unsigned int)m_CenterX.size(); }
+
+	static const char* GetKernelName(); // "AVX", "SSE" or "Scalar", fixed at compile time
+};
\ No newline at end of file
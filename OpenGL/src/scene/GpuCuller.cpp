@@ -0,0 +1,176 @@
+#include "GpuCuller.h"
+#include "FrustumCuller.h"
+#include "../Renderer.h"
+#include "../buffers/VertexBufferLayout.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+static const unsigned int CULL_GROUP_SIZE = 64; // local_size_x in GpuCull.shader
+static const unsigned int OBJECT_BINDING = 0;
+static const unsigned int COMMAND_BINDING = 2;
+static const unsigned int COUNT_BINDING = 3;
+
+GpuCuller::GpuCuller(const AssetPack& pack, MeshArena& arena, unsigned int maxObjects)
+	: m_Arena(arena), m_CullShader(pack, "res/shaders/GpuCull.shader"), m_MaxObjects(maxObjects),
+	m_DirtyFirst(0), m_DirtyEnd(0), m_CulledViewProjection(1.0f),
+	m_ObjectBuffer(maxObjects * (unsigned int)sizeof(GpuObject), BufferUsage::Dynamic),
+	m_TransformBuffer(maxObjects * (unsigned int)sizeof(glm::mat4), BufferUsage::Dynamic),
+	m_CommandBuffer(maxObjects * (unsigned int)sizeof(DrawElementsIndirectCommand), BufferUsage::Dynamic),
+	m_CountBuffer((unsigned int)sizeof(unsigned int), BufferUsage::Dynamic),
+	m_ObjectIndices(maxObjects * (unsigned int)sizeof(unsigned int), BufferUsage::Static),
+	m_HasDrawCount(GLEW_ARB_indirect_parameters != 0)
+{
+	std::vector<unsigned int> indices(maxObjects);
+	for (unsigned int i = 0; i < maxObjects; i++) {
+		indices[i] = i;
+	}
+	m_ObjectIndices.SetData(0, indices.data(), maxObjects * (unsigned int)sizeof(unsigned int));
+
+	// With a divisor of 1 the attribute is fetched at baseInstance, which the culling pass sets to the object index
+	VertexBufferLayout layout;
+	layout.PushInteger<unsigned int>(1);
+	m_Arena.AddInstanceBuffer(m_ObjectIndices, layout);
+}
+
+unsigned int GpuCuller::Add(MeshHandle mesh, const glm::mat4& model, const glm::vec3& center, float radius) {
+	const MeshLodLevel whole = { 0, m_Arena.GetRange(mesh).indexCount, 0.0f };
+	return Add(mesh, whole, model, center, radius);
+}
+
+unsigned int GpuCuller::Add(MeshHandle mesh, const MeshLodLevel& level, const glm::mat4& model, const glm::vec3& center, float radius) {
+	if (GetCount() >= m_MaxObjects) {
+		return INVALID_INDEX;
+	}
+	ASSERT(level.firstIndex + level.indexCount <= m_Arena.GetRange(mesh).indexCount);
+	m_Meshes.push_back(mesh);
+	m_Levels.push_back(level);
+	m_LocalSpheres.push_back(glm::vec4(center, radius));
+	m_Objects.push_back(GpuObject());
+	m_Transforms.push_back(model);
+	UpdateObject(GetCount() - 1);
+	return GetCount() - 1;
+}
+
+void GpuCuller::SetTransform(unsigned int index, const glm::mat4& model) {
+	m_Transforms[index] = model;
+	UpdateObject(index);
+}
+
+void GpuCuller::UpdateMeshRanges() {
+	for (unsigned int i = 0; i < GetCount(); i++) {
+		UpdateObject(i);
+	}
+}
+
+void GpuCuller::UpdateObject(unsigned int index) {
+	const MeshRange& range = m_Arena.GetRange(m_Meshes[index]);
+	const glm::mat4& model = m_Transforms[index];
+	const glm::vec4& local = m_LocalSpheres[index];
+	const float scale = std::max(std::max(glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1]))), glm::length(glm::vec3(model[2])));
+
+	GpuObject& object = m_Objects[index];
+	object.sphere = glm::vec4(glm::vec3(model * glm::vec4(glm::vec3(local), 1.0f)), local.w * scale);
+	object.indexCount = m_Levels[index].indexCount;
+	object.firstIndex = range.firstIndex + m_Levels[index].firstIndex; // Levels share the mesh's base vertex
+	object.baseVertex = (int)range.baseVertex;
+	object.padding = 0;
+
+	// One contiguous range covers every change, a frame that moves nothing uploads nothing
+	if (m_DirtyFirst == m_DirtyEnd) {
+		m_DirtyFirst = index;
+		m_DirtyEnd = index + 1;
+	}
+	else {
+		m_DirtyFirst = std::min(m_DirtyFirst, index);
+		m_DirtyEnd = std::max(m_DirtyEnd, index + 1);
+	}
+}
+
+void GpuCuller::Cull(const glm::mat4& viewProjection) {
+	if (m_DirtyFirst != m_DirtyEnd) {
+		const unsigned int count = m_DirtyEnd - m_DirtyFirst;
+		m_ObjectBuffer.SetData(m_DirtyFirst * (unsigned int)sizeof(GpuObject), &m_Objects[m_DirtyFirst], count * (unsigned int)sizeof(GpuObject));
+		m_TransformBuffer.SetData(m_DirtyFirst * (unsigned int)sizeof(glm::mat4), &m_Transforms[m_DirtyFirst], count * (unsigned int)sizeof(glm::mat4));
+		m_DirtyFirst = m_DirtyEnd = 0;
+	}
+	if (GetCount() == 0) {
+		return;
+	}
+
+	const unsigned int zero = 0;
+	m_CountBuffer.SetData(0, &zero, sizeof(zero)); // The pass appends from 0
+
+	m_CulledViewProjection = viewProjection;
+	const Frustum frustum = ExtractFrustum(viewProjection);
+	m_CullShader.Bind();
+	m_CullShader.SetUniform4fv("u_Planes", 6, &frustum.planes[0].x);
+	m_CullShader.SetUniform1i("u_ObjectCount", (int)GetCount());
+	m_CullShader.SetUniform1i("u_Compact", m_HasDrawCount ? 1 : 0);
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, m_ObjectBuffer.GetRendererID()));
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, m_CommandBuffer.GetRendererID()));
+	GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNT_BINDING, m_CountBuffer.GetRendererID()));
+	GLCall(glDispatchCompute((GetCount() + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1));
+
+	// The draws read the commands and the count as indirect parameters, the next frame's SetData
+	// overwrites the count the pass wrote, and shaders may read the buffers as storage
+	GLCall(glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT));
+}
+
+unsigned int GpuCuller::Validate(unsigned int* gpuVisible) const {
+	const unsigned int count = GetCount();
+	std::vector<DrawElementsIndirectCommand> commands(count);
+	unsigned int drawCount = count;
+	if (count > 0) {
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, m_CommandBuffer.GetRendererID()));
+		GLCall(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, count * sizeof(DrawElementsIndirectCommand), commands.data()));
+		if (m_HasDrawCount) {
+			GLCall(glBindBuffer(GL_COPY_READ_BUFFER, m_CountBuffer.GetRendererID()));
+			GLCall(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(drawCount), &drawCount));
+		}
+		GLCall(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+	}
+
+	// Which objects the GPU kept, and whether their draws cover the right index ranges
+	unsigned int mismatches = 0;
+	std::vector<unsigned char> kept(count, 0);
+	for (unsigned int i = 0; i < std::min(drawCount, count); i++) {
+		const DrawElementsIndirectCommand& command = commands[i];
+		if (command.instanceCount == 0) {
+			continue;
+		}
+		const unsigned int index = command.baseInstance;
+		if (index >= count || kept[index] || command.count != m_Objects[index].indexCount
+			|| command.firstIndex != m_Objects[index].firstIndex || command.baseVertex != m_Objects[index].baseVertex) {
+			mismatches++;
+			continue;
+		}
+		kept[index] = 1;
+	}
+
+	const Frustum frustum = ExtractFrustum(m_CulledViewProjection);
+	unsigned int visible = 0;
+	for (unsigned int i = 0; i < count; i++) {
+		const glm::vec4& sphere = m_Objects[i].sphere;
+		float margin = FLT_MAX; // Of the closest plane, negative outside
+		for (const glm::vec4& plane : frustum.planes) {
+			margin = std::min(margin, glm::dot(glm::vec3(plane), glm::vec3(sphere)) + plane.w + sphere.w);
+		}
+		visible += kept[i];
+		if (std::fabs(margin) <= 1e-4f * std::max(1.0f, sphere.w)) {
+			continue; // Touching a plane, float rounding decides either way
+		}
+		if ((margin >= 0.0f) != (kept[i] != 0)) {
+			mismatches++;
+		}
+	}
+	if (gpuVisible) {
+		*gpuVisible = visible;
+	}
+	return mismatches;
+}
+
+bool GpuCuller::IsSupported() {
+	return GLEW_VERSION_4_3 != 0;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "../Shader.h"
+#include "../buffers/VertexBuffer.h"
+#include "../buffers/MeshArena.h"
+#include "../mesh/MeshLod.h"
+
+// Layout glMultiDrawElementsIndirect reads, 20 bytes per draw
+struct DrawElementsIndirectCommand {
+	unsigned int count;
+	unsigned int instanceCount;
+	unsigned int firstIndex;
+	int baseVertex;
+	unsigned int baseInstance;
+};
+
+// Culls the objects of one MeshArena on the GPU and leaves one indirect draw per object behind,
+// so the CPU submits the whole scene with a single Renderer::DrawIndirect whatever its size.
+// Objects (world-space bounding sphere and mesh range) and their model matrices live in shader
+// storage buffers and are only uploaded when they change. res/shaders/GpuCull.shader tests every
+// sphere against the frustum; with GL_ARB_indirect_parameters it appends the visible draws and
+// their count, otherwise every draw stays in place and hidden ones get 0 instances.
+// Each draw's baseInstance is its object index, read by the vertex shader through a per-instance
+// attribute at the location after the arena's layout, see res/shaders/Indirect.shader.
+// Needs GL 4.3 (compute shaders, shader storage buffers, multi-draw indirect).
+class GpuCuller {
+private:
+	struct GpuObject { // std430, matches GpuCull.shader
+		glm::vec4 sphere; // World-space center and radius
+		unsigned int indexCount;
+		unsigned int firstIndex;
+		int baseVertex;
+		unsigned int padding;
+	};
+
+	MeshArena& m_Arena;
+	Shader m_CullShader;
+	unsigned int m_MaxObjects;
+	std::vector<MeshHandle> m_Meshes;
+	std::vector<MeshLodLevel> m_Levels; // Index sub-range of each object's mesh it draws
+	std::vector<glm::vec4> m_LocalSpheres; // Object-space bounds, moved to world space by the model matrix
+	std::vector<GpuObject> m_Objects;
+	std::vector<glm::mat4> m_Transforms;
+	unsigned int m_DirtyFirst, m_DirtyEnd; // Objects changed since the last upload
+	glm::mat4 m_CulledViewProjection; // Of the last Cull, for Validate
+
+	VertexBuffer m_ObjectBuffer; // Any buffer name binds to any target, these are storage buffers
+	VertexBuffer m_TransformBuffer;
+	VertexBuffer m_CommandBuffer; // GL_DRAW_INDIRECT_BUFFER
+	VertexBuffer m_CountBuffer; // GL_PARAMETER_BUFFER_ARB, one uint
+	VertexBuffer m_ObjectIndices; // 0, 1, 2... as the per-instance attribute
+	bool m_HasDrawCount;
+public:
+	GpuCuller(const AssetPack& pack, MeshArena& arena, unsigned int maxObjects); // Loads res/shaders/GpuCull.shader
+
+	GpuCuller(const GpuCuller&) = delete;
+	GpuCuller& operator=(const GpuCuller&) = delete;
+
+	// Returns the object's index, or INVALID_INDEX once maxObjects are in
+	unsigned int Add(MeshHandle mesh, const glm::mat4& model, const glm::vec3& center, float radius);
+	// Draws one level of a MeshLodChain stored as mesh, the whole mesh would draw every level at once
+	unsigned int Add(MeshHandle mesh, const MeshLodLevel& level, const glm::mat4& model, const glm::vec3& center, float radius);
+	void SetTransform(unsigned int index, const glm::mat4& model);
+	void UpdateMeshRanges(); // After MeshArena::Defragment moved the meshes
+
+	// Uploads what changed, then dispatches the culling pass. Draw with Renderer::DrawIndirect after it.
+	void Cull(const glm::mat4& viewProjection);
+
+	// Reads the last Cull's draws back and repeats its sphere test on the CPU, returns how many
+	// objects disagree; objects within rounding of a plane are skipped. Call it before objects
+	// change again. Waits for the GPU, meant for debugging and for checking drivers (llvmpipe).
+	unsigned int Validate(unsigned int* gpuVisible = nullptr) const;
+
+	inline const VertexBuffer& GetCommandBuffer() const { return m_CommandBuffer; }
+	inline const VertexBuffer& GetCountBuffer() const { return m_CountBuffer; }
+	inline const VertexBuffer& GetTransformBuffer() const { return m_TransformBuffer; }
+	inline const MeshArena& GetArena() const { return m_Arena; }
+	inline bool HasDrawCount() const { return m_HasDrawCount; } // Visible draws are packed and counted on the GPU
+	inline unsigned int GetCount() const { return (unsigned int)m_Objects.size(); }
+
+	static bool IsSupported(); // GL 4.3 or newer
+	static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+	static const unsigned int TRANSFORM_BINDING = 1; // Shader storage binding of the model matrices
+private:
+	void UpdateObject(unsigned int index);
+};
\ No newline at end of file
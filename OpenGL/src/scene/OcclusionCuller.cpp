@@ -0,0 +1,159 @@
+#include "OcclusionCuller.h"
+#include "../Renderer.h"
+#include "../buffers/VertexBufferLayout.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+// Unit cube, corner i has x, y and z set by bits 0, 1 and 2, faces wound counter-clockwise from outside
+static const float BOX_VERTICES[] = {
+	-1.0f, -1.0f, -1.0f,  1.0f, -1.0f, -1.0f,  -1.0f, 1.0f, -1.0f,  1.0f, 1.0f, -1.0f,
+	-1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f,  -1.0f, 1.0f,  1.0f,  1.0f, 1.0f,  1.0f
+};
+static const unsigned int BOX_INDICES[] = {
+	4, 6, 2, 2, 0, 4, // -x
+	1, 3, 7, 7, 5, 1, // +x
+	0, 1, 5, 5, 4, 0, // -y
+	6, 7, 3, 3, 2, 6, // +y
+	2, 3, 1, 1, 0, 2, // -z
+	4, 5, 7, 7, 6, 4 // +z
+};
+
+OcclusionCuller::OcclusionCuller(const AssetPack& pack)
+	: m_BoundsShader(pack, "res/shaders/Bounds.shader"), m_ViewProjection(1.0f), m_CameraPosition(0.0f), m_NearPlane(0.1f)
+{
+	m_BoxArray.Bind(); // Creating the index buffer binds it, make sure it lands in our VAO
+	m_BoxVertices.reset(new VertexBuffer(BOX_VERTICES, sizeof(BOX_VERTICES)));
+	m_BoxIndices.reset(new IndexBuffer(BOX_INDICES, sizeof(BOX_INDICES) / sizeof(BOX_INDICES[0])));
+
+	VertexBufferLayout layout;
+	layout.Push<float>(3);
+	m_BoxArray.AddBuffer(*m_BoxVertices, layout);
+	m_BoxArray.SetIndexBuffer(*m_BoxIndices);
+	m_BoxArray.Unbind();
+}
+
+OcclusionCuller::~OcclusionCuller() {
+	for (const Object& object : m_Objects) {
+		GLCall(glDeleteQueries(1, &object.query));
+	}
+}
+
+unsigned int OcclusionCuller::Add(const glm::vec3& min, const glm::vec3& max) {
+	Object object = {};
+	object.min = min;
+	object.max = max;
+	object.visible = true; // Drawn, and so queried, until a result says otherwise
+	GLCall(glGenQueries(1, &object.query));
+	m_Objects.push_back(object);
+	return GetCount() - 1;
+}
+
+void OcclusionCuller::SetBounds(unsigned int index, const glm::vec3& min, const glm::vec3& max) {
+	m_Objects[index].min = min;
+	m_Objects[index].max = max;
+}
+
+void OcclusionCuller::RemoveSwap(unsigned int index) {
+	ASSERT(index < GetCount());
+	GLCall(glDeleteQueries(1, &m_Objects[index].query));
+	m_Objects[index] = m_Objects.back();
+	m_Objects.pop_back();
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, float nearPlane) {
+	m_ViewProjection = viewProjection;
+	m_CameraPosition = cameraPosition;
+	m_NearPlane = nearPlane;
+	m_Frame++;
+	m_Stats = { GetCount(), 0, 0 };
+
+	for (Object& object : m_Objects) {
+		if (object.pending) {
+			// Issued last frame or earlier, take the result only if it is already there
+			GLuint available = 0;
+			GLCall(glGetQueryObjectuiv(object.query, GL_QUERY_RESULT_AVAILABLE, &available));
+			if (available) {
+				GLuint anySamples = 0;
+				GLCall(glGetQueryObjectuiv(object.query, GL_QUERY_RESULT, &anySamples));
+				object.visible = anySamples != 0;
+				object.pending = false;
+			}
+		}
+		if (!object.visible) {
+			m_Stats.occluded++;
+		}
+	}
+}
+
+void OcclusionCuller::BeginDraw(unsigned int index) {
+	Object& object = m_Objects[index];
+
+	// The near plane would clip a box around the camera and hide it, just draw
+	const glm::vec3 margin(m_NearPlane * 2.0f);
+	if (glm::all(glm::greaterThanEqual(m_CameraPosition, object.min - margin)) && glm::all(glm::lessThanEqual(m_CameraPosition, object.max + margin))) {
+		object.visible = true;
+		return;
+	}
+
+	if (object.pending) {
+		// The last query is still in flight, the GPU uses its result if it has one by now
+		if (!object.visible) {
+			GLCall(glBeginConditionalRender(object.query, GL_QUERY_NO_WAIT));
+			object.conditional = true;
+		}
+		return;
+	}
+
+	if (object.visible) {
+		// The draw itself is the query, every few frames, staggered so queries spread over frames
+		if ((m_Frame + index) % m_VisibleQueryInterval == 0) {
+			GLCall(glBeginQuery(GL_ANY_SAMPLES_PASSED, object.query));
+			object.queryingDraw = true;
+			object.pending = true;
+			m_Stats.queries++;
+		}
+		return;
+	}
+
+	// Hidden last time, test the box and let the GPU skip the draw while it stays hidden.
+	// The wait is on the GPU for a box it just rasterized, the CPU carries on.
+	GLCall(glBeginQuery(GL_ANY_SAMPLES_PASSED, object.query));
+	DrawBox(object);
+	GLCall(glEndQuery(GL_ANY_SAMPLES_PASSED));
+	object.pending = true;
+	m_Stats.queries++;
+
+	GLCall(glBeginConditionalRender(object.query, GL_QUERY_WAIT));
+	object.conditional = true;
+}
+
+void OcclusionCuller::EndDraw(unsigned int index) {
+	Object& object = m_Objects[index];
+	if (object.queryingDraw) {
+		GLCall(glEndQuery(GL_ANY_SAMPLES_PASSED));
+		object.queryingDraw = false;
+	}
+	if (object.conditional) {
+		GLCall(glEndConditionalRender());
+		object.conditional = false;
+	}
+}
+
+void OcclusionCuller::DrawBox(const Object& object) {
+	const glm::vec3 center = (object.min + object.max) * 0.5f;
+	const glm::vec3 extent = (object.max - object.min) * 0.5f;
+	const glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), center), extent);
+
+	// Depth test only, the box must neither show nor occlude anything. The caller's depth mask is
+	// put back afterwards, a pass after a depth pre-pass draws with writes off.
+	GLboolean depthMask;
+	GLCall(glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask));
+	GLCall(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+	GLCall(glDepthMask(GL_FALSE));
+	m_BoundsShader.Bind();
+	m_BoundsShader.SetUniformMat4f("u_MVP", m_ViewProjection * model);
+	m_BoxArray.Bind();
+	GLCall(glDrawElements(GL_TRIANGLES, m_BoxIndices->GetCount(), m_BoxIndices->GetType(), nullptr));
+	GLCall(glDepthMask(depthMask));
+	GLCall(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+}
\ No newline at end of file
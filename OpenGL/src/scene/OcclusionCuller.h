@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "../Shader.h"
+#include "../buffers/VertexArray.h"
+#include "../buffers/VertexBuffer.h"
+#include "../buffers/IndexBuffer.h"
+
+struct OcclusionStats {
+	unsigned int objects;
+	unsigned int queries; // Issued this frame
+	unsigned int occluded; // Known hidden as of the latest results, drawn conditionally
+};
+
+// Hardware occlusion culling with GL_ANY_SAMPLES_PASSED queries against bounding boxes.
+// Results are read one frame late, and only once available, so the CPU never waits on the GPU.
+// Objects last seen hidden get a box query every frame and are drawn inside
+// glBeginConditionalRender, so the GPU drops them while the box stays hidden and they never
+// pop in late. Objects last seen visible are drawn normally and their own draw is the query,
+// repeated only every few frames while they stay visible. Needs depth testing on, and works
+// best when occluders are drawn first (front to back):
+//
+//     culler.BeginFrame(proj * view, cameraPosition);
+//     for (unsigned int i : frontToBack) {
+//         culler.BeginDraw(i);
+//         renderer.Draw(va, ib, shader);
+//         culler.EndDraw(i);
+//     }
+class OcclusionCuller {
+private:
+	struct Object {
+		glm::vec3 min, max;
+		unsigned int query; // GL query name
+		bool pending; // Result not read yet
+		bool visible; // As of the latest result
+		bool queryingDraw; // The current draw is inside the query
+		bool conditional; // The current draw is inside conditional rendering
+	};
+
+	std::vector<Object> m_Objects;
+	Shader m_BoundsShader;
+	VertexArray m_BoxArray;
+	std::unique_ptr<VertexBuffer> m_BoxVertices; // Created once m_BoxArray is bound, see the constructor
+	std::unique_ptr<IndexBuffer> m_BoxIndices;
+
+	glm::mat4 m_ViewProjection;
+	glm::vec3 m_CameraPosition;
+	float m_NearPlane;
+	unsigned int m_Frame = 0;
+	unsigned int m_VisibleQueryInterval = 4; // Frames between queries of an object that stays visible, staggered by index
+	OcclusionStats m_Stats = { 0, 0, 0 };
+public:
+	OcclusionCuller(const AssetPack& pack); // Loads res/shaders/Bounds.shader
+	~OcclusionCuller();
+
+	// Query names are owned, so the culler is never copied
+	OcclusionCuller(const OcclusionCuller&) = delete;
+	OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+	unsigned int Add(const glm::vec3& min, const glm::vec3& max); // Returns the object's index, starts out visible
+	void SetBounds(unsigned int index, const glm::vec3& min, const glm::vec3& max);
+	void RemoveSwap(unsigned int index); // Moves the last object into index
+
+	// Collects whatever results arrived since last frame. nearPlane is the projection's near
+	// distance, a camera that close to a box is inside it and the object is simply drawn.
+	void BeginFrame(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, float nearPlane = 0.1f);
+	void BeginDraw(unsigned int index); // Around the object's own draw calls
+	void EndDraw(unsigned int index);
+
+	inline void SetVisibleQueryInterval(unsigned int frames) { m_VisibleQueryInterval = frames ? frames : 1; }
+	inline bool IsVisible(unsigned int index) const { return m_Objects[index].visible; } // As of the latest result
+	inline const OcclusionStats& GetStats() const { return m_Stats; } // Of the frame since BeginFrame
+	inline unsigned int GetCount() const { return (unsigned int)m_Objects.size(); }
+private:
+	void DrawBox(const Object& object);
+};
\ No newline at end of file
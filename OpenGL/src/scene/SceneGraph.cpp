@@ -0,0 +1,206 @@
+#include "SceneGraph.h"
+#include "../Renderer.h"
+
+#include <algorithm>
+
+SceneNode SceneGraph::CreateNode(SceneNode parent, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	unsigned int parentIndex = INVALID_ID;
+	unsigned int at = GetNodeCount();
+	if (parent.id != INVALID_ID) {
+		ASSERT(IsValid(parent));
+		parentIndex = m_IdToIndex[parent.id];
+		at = parentIndex + m_SubtreeSize[parentIndex]; // After the parent's last descendant
+	}
+
+	unsigned int id;
+	if (!m_FreeIds.empty()) {
+		id = m_FreeIds.back();
+		m_FreeIds.pop_back();
+	}
+	else {
+		id = (unsigned int)m_IdToIndex.size();
+		m_IdToIndex.push_back(INVALID_ID);
+		m_Queued.push_back(0);
+	}
+
+	InsertNodes(at, 1);
+	m_Parent[at] = parentIndex;
+	m_SubtreeSize[at] = 1;
+	m_Position[at] = position;
+	m_Rotation[at] = rotation;
+	m_Scale[at] = scale;
+	m_IndexToId[at] = id;
+	m_IdToIndex[id] = at;
+	ResizeAncestors(parentIndex, 1);
+
+	MarkDirty(at);
+	return { id };
+}
+
+void SceneGraph::DestroyNode(SceneNode node) {
+	ASSERT(IsValid(node));
+	unsigned int index = m_IdToIndex[node.id];
+	unsigned int size = m_SubtreeSize[index];
+	unsigned int parentIndex = m_Parent[index]; // Before index, so erasing doesn't move it
+
+	for (unsigned int i = index; i < index + size; i++) {
+		m_IdToIndex[m_IndexToId[i]] = INVALID_ID; // Update skips these if they are still queued
+		m_FreeIds.push_back(m_IndexToId[i]);
+	}
+	EraseNodes(index, size);
+	ResizeAncestors(parentIndex, -(int)size);
+}
+
+void SceneGraph::SetParent(SceneNode node, SceneNode parent) {
+	ASSERT(IsValid(node));
+	unsigned int index = m_IdToIndex[node.id];
+	unsigned int size = m_SubtreeSize[index];
+	if (parent.id != INVALID_ID) {
+		ASSERT(IsValid(parent));
+		unsigned int parentIndex = m_IdToIndex[parent.id];
+		ASSERT(parentIndex < index || parentIndex >= index + size); // Would make the subtree its own ancestor
+	}
+
+	// Take the subtree out, parents relative to its root so they survive the move
+	std::vector<unsigned int> parents(size), subtreeSizes(size), ids(size);
+	std::vector<glm::vec3> positions(size), scales(size);
+	std::vector<glm::quat> rotations(size);
+	for (unsigned int k = 0; k < size; k++) {
+		parents[k] = k == 0 ? 0 : m_Parent[index + k] - index;
+		subtreeSizes[k] = m_SubtreeSize[index + k];
+		positions[k] = m_Position[index + k];
+		rotations[k] = m_Rotation[index + k];
+		scales[k] = m_Scale[index + k];
+		ids[k] = m_IndexToId[index + k];
+	}
+	unsigned int oldParentIndex = m_Parent[index];
+	EraseNodes(index, size);
+	ResizeAncestors(oldParentIndex, -(int)size);
+
+	// And back in after the new parent's last descendant
+	unsigned int parentIndex = INVALID_ID;
+	unsigned int at = GetNodeCount();
+	if (parent.id != INVALID_ID) {
+		parentIndex = m_IdToIndex[parent.id];
+		at = parentIndex + m_SubtreeSize[parentIndex];
+	}
+	InsertNodes(at, size);
+	for (unsigned int k = 0; k < size; k++) {
+		m_Parent[at + k] = k == 0 ? parentIndex : at + parents[k];
+		m_SubtreeSize[at + k] = subtreeSizes[k];
+		m_Position[at + k] = positions[k];
+		m_Rotation[at + k] = rotations[k];
+		m_Scale[at + k] = scales[k];
+		m_IndexToId[at + k] = ids[k];
+		m_IdToIndex[ids[k]] = at + k;
+	}
+	ResizeAncestors(parentIndex, (int)size);
+
+	MarkDirty(at); // Local transforms are kept, the world matrices change with the new parent
+}
+
+void SceneGraph::SetLocalTransform(SceneNode node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	unsigned int index = m_IdToIndex[node.id];
+	m_Position[index] = position;
+	m_Rotation[index] = rotation;
+	m_Scale[index] = scale;
+	MarkDirty(index);
+}
+
+void SceneGraph::SetLocalPosition(SceneNode node, const glm::vec3& position) {
+	unsigned int index = m_IdToIndex[node.id];
+	m_Position[index] = position;
+	MarkDirty(index);
+}
+
+void SceneGraph::SetLocalRotation(SceneNode node, const glm::quat& rotation) {
+	unsigned int index = m_IdToIndex[node.id];
+	m_Rotation[index] = rotation;
+	MarkDirty(index);
+}
+
+void SceneGraph::SetLocalScale(SceneNode node, const glm::vec3& scale) {
+	unsigned int index = m_IdToIndex[node.id];
+	m_Scale[index] = scale;
+	MarkDirty(index);
+}
+
+unsigned int SceneGraph::Update() {
+	if (m_DirtyIds.empty())
+		return 0;
+
+	m_DirtyRanges.clear();
+	for (unsigned int id : m_DirtyIds) {
+		m_Queued[id] = 0;
+		if (m_IdToIndex[id] != INVALID_ID)
+			m_DirtyRanges.push_back(m_IdToIndex[id]);
+	}
+	m_DirtyIds.clear();
+	std::sort(m_DirtyRanges.begin(), m_DirtyRanges.end());
+
+	// In depth-first order every parent is done before its children, and a queued node inside
+	// a subtree that was already recomputed is covered by it
+	unsigned int recomputed = 0;
+	unsigned int end = 0;
+	for (unsigned int first : m_DirtyRanges) {
+		if (first < end)
+			continue;
+		end = first + m_SubtreeSize[first];
+		for (unsigned int i = first; i < end; i++) {
+			glm::mat4 local = glm::mat4_cast(m_Rotation[i]);
+			local[0] *= m_Scale[i].x;
+			local[1] *= m_Scale[i].y;
+			local[2] *= m_Scale[i].z;
+			local[3] = glm::vec4(m_Position[i], 1.0f);
+			m_World[i] = m_Parent[i] == INVALID_ID ? local : m_World[m_Parent[i]] * local;
+		}
+		recomputed += end - first;
+	}
+	return recomputed;
+}
+
+void SceneGraph::MarkDirty(unsigned int index) {
+	unsigned int id = m_IndexToId[index];
+	if (m_Queued[id])
+		return;
+	m_Queued[id] = 1;
+	m_DirtyIds.push_back(id);
+}
+
+void SceneGraph::InsertNodes(unsigned int at, unsigned int count) {
+	m_Parent.insert(m_Parent.begin() + at, count, INVALID_ID);
+	m_SubtreeSize.insert(m_SubtreeSize.begin() + at, count, 0);
+	m_Position.insert(m_Position.begin() + at, count, glm::vec3(0.0f));
+	m_Rotation.insert(m_Rotation.begin() + at, count, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	m_Scale.insert(m_Scale.begin() + at, count, glm::vec3(1.0f));
+	m_World.insert(m_World.begin() + at, count, glm::mat4(1.0f));
+	m_IndexToId.insert(m_IndexToId.begin() + at, count, INVALID_ID);
+
+	for (unsigned int i = at + count; i < GetNodeCount(); i++) {
+		if (m_Parent[i] != INVALID_ID && m_Parent[i] >= at)
+			m_Parent[i] += count;
+		m_IdToIndex[m_IndexToId[i]] = i;
+	}
+}
+
+void SceneGraph::EraseNodes(unsigned int at, unsigned int count) {
+	m_Parent.erase(m_Parent.begin() + at, m_Parent.begin() + at + count);
+	m_SubtreeSize.erase(m_SubtreeSize.begin() + at, m_SubtreeSize.begin() + at + count);
+	m_Position.erase(m_Position.begin() + at, m_Position.begin() + at + count);
+	m_Rotation.erase(m_Rotation.begin() + at, m_Rotation.begin() + at + count);
+	m_Scale.erase(m_Scale.begin() + at, m_Scale.begin() + at + count);
+	m_World.erase(m_World.begin() + at, m_World.begin() + at + count);
+	m_IndexToId.erase(m_IndexToId.begin() + at, m_IndexToId.begin() + at + count);
+
+	// Whole subtrees are erased, so no remaining node had its parent in the range
+	for (unsigned int i = at; i < GetNodeCount(); i++) {
+		if (m_Parent[i] != INVALID_ID && m_Parent[i] >= at)
+			m_Parent[i] -= count;
+		m_IdToIndex[m_IndexToId[i]] = i;
+	}
+}
+
+void SceneGraph::ResizeAncestors(unsigned int parentIndex, int delta) {
+	for (unsigned int i = parentIndex; i != INVALID_ID; i = m_Parent[i])
+		m_SubtreeSize[i] += delta;
+}
\ No newline at end of file
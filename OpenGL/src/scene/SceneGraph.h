@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+// Stable reference to a node, survives the reordering done by structural edits
+struct SceneNode {
+	unsigned int id;
+};
+
+// Transform hierarchy in flat arrays kept in depth-first order: a parent always comes before
+// its children and every subtree is one contiguous range. Changing a local transform only
+// queues the node, Update() then recomputes just the queued subtrees, in order, so a frame
+// where nothing moved costs nothing. World matrices are contiguous, ready for upload.
+// Structural edits (create, destroy, reparent) shift the arrays and are O(nodes).
+class SceneGraph {
+private:
+	// Per node, indexed by depth-first position
+	std::vector<unsigned int> m_Parent; // Index of the parent, INVALID_ID for roots
+	std::vector<unsigned int> m_SubtreeSize; // Node itself plus all descendants
+	std::vector<glm::vec3> m_Position;
+	std::vector<glm::quat> m_Rotation;
+	std::vector<glm::vec3> m_Scale;
+	std::vector<glm::mat4> m_World;
+	std::vector<unsigned int> m_IndexToId;
+
+	std::vector<unsigned int> m_IdToIndex; // INVALID_ID for destroyed nodes
+	std::vector<unsigned int> m_FreeIds;
+	std::vector<unsigned char> m_Queued; // Per id, set while the id is in m_DirtyIds
+	std::vector<unsigned int> m_DirtyIds; // Nodes whose subtree needs new world matrices
+	std::vector<unsigned int> m_DirtyRanges; // Scratch for Update
+public:
+	static constexpr unsigned int INVALID_ID = 0xFFFFFFFF;
+
+	SceneGraph() = default;
+
+	// Adds a node as the last child of parent, or as a root when parent is { INVALID_ID }
+	SceneNode CreateNode(SceneNode parent = { INVALID_ID }, const glm::vec3& position = glm::vec3(0.0f),
+		const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f));
+	void DestroyNode(SceneNode node); // Destroys the whole subtree
+	void SetParent(SceneNode node, SceneNode parent); // Moves the subtree, parent may not be inside it
+
+	void SetLocalTransform(SceneNode node, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	void SetLocalPosition(SceneNode node, const glm::vec3& position);
+	void SetLocalRotation(SceneNode node, const glm::quat& rotation);
+	void SetLocalScale(SceneNode node, const glm::vec3& scale);
+
+	// Recomputes the world matrices of every changed subtree, returns how many were recomputed
+	unsigned int Update();
+
+	inline bool IsValid(SceneNode node) const { return node.id < m_IdToIndex.size() && m_IdToIndex[node.id] != INVALID_ID; }
+	inline const glm::mat4& GetWorldMatrix(SceneNode node) const { return m_World[m_IdToIndex[node.id]]; } // As of the last Update
+	inline unsigned int GetIndex(SceneNode node) const { return m_IdToIndex[node.id]; } // Position in GetWorldMatrices, changes with structural edits
+	inline SceneNode GetNode(unsigned int index) const { return { m_IndexToId[index] }; }
+	inline SceneNode GetParent(SceneNode node) const {
+		unsigned int parent = m_Parent[m_IdToIndex[node.id]];
+		return { parent == INVALID_ID ? INVALID_ID : m_IndexToId[parent] };
+	}
+
+	inline const glm::mat4* GetWorldMatrices() const { return m_World.data(); }
+	inline unsigned int GetNodeCount() const { return (unsigned int)m_World.size(); }
+private:
+	void MarkDirty(unsigned int index);
+	void InsertNodes(unsigned int at, unsigned int count); // Opens a gap of count nodes at index at
+	void EraseNodes(unsigned int at, unsigned int count);
+	void ResizeAncestors(unsigned int parentIndex, int delta); // Adds delta to the subtree size of parentIndex and its ancestors
+};
\ No newline at end of file
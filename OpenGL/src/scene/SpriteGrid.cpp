@@ -0,0 +1,152 @@
+#include "SpriteGrid.h"
+#include "../Renderer.h"
+
+#include <cfloat>
+#include <cmath>
+
+static inline uint64_t PackCell(int x, int y) {
+	return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+SpriteGrid::SpriteGrid(float cellSize)
+	: m_CellSize(cellSize) {
+	ASSERT(cellSize > 0.0f);
+}
+
+uint64_t SpriteGrid::GetCellKey(const glm::vec2& position) const {
+	return PackCell((int)std::floor(position.x / m_CellSize), (int)std::floor(position.y / m_CellSize));
+}
+
+unsigned int SpriteGrid::Insert(const glm::vec2& center, const glm::vec2& halfSize) {
+	unsigned int sprite;
+	if (!m_FreeIds.empty()) {
+		sprite = m_FreeIds.back();
+		m_FreeIds.pop_back();
+	}
+	else {
+		sprite = (unsigned int)m_Center.size();
+		m_Center.push_back(glm::vec2(0.0f));
+		m_HalfSize.push_back(glm::vec2(0.0f));
+		m_Next.push_back(NONE);
+		m_Previous.push_back(NONE);
+		m_Cell.push_back(0);
+		m_Alive.push_back(0);
+	}
+
+	m_Center[sprite] = center;
+	m_HalfSize[sprite] = halfSize;
+	m_Alive[sprite] = 1;
+	m_MaxHalfSize = glm::max(m_MaxHalfSize, halfSize);
+	m_Count++;
+	Link(sprite);
+	return sprite;
+}
+
+void SpriteGrid::Remove(unsigned int sprite) {
+	ASSERT(IsValid(sprite));
+	Unlink(sprite);
+	m_Alive[sprite] = 0;
+	m_FreeIds.push_back(sprite);
+	m_Count--;
+}
+
+void SpriteGrid::Move(unsigned int sprite, const glm::vec2& center) {
+	ASSERT(IsValid(sprite));
+	m_Center[sprite] = center;
+	if (GetCellKey(center) == m_Cell[sprite]) {
+		return;
+	}
+	Unlink(sprite);
+	Link(sprite);
+}
+
+void SpriteGrid::Link(unsigned int sprite) {
+	const uint64_t key = GetCellKey(m_Center[sprite]);
+	m_Cell[sprite] = key;
+	m_Previous[sprite] = NONE;
+
+	auto cell = m_Cells.find(key);
+	if (cell == m_Cells.end()) {
+		m_Next[sprite] = NONE;
+		m_Cells.emplace(key, sprite);
+		return;
+	}
+	m_Next[sprite] = cell->second; // Push front
+	m_Previous[cell->second] = sprite;
+	cell->second = sprite;
+}
+
+void SpriteGrid::Unlink(unsigned int sprite) {
+	const unsigned int next = m_Next[sprite];
+	const unsigned int previous = m_Previous[sprite];
+	if (next != NONE) {
+		m_Previous[next] = previous;
+	}
+	if (previous != NONE) {
+		m_Next[previous] = next;
+		return;
+	}
+
+	// First in its cell, the cell now starts at next or is empty and goes away
+	if (next != NONE) {
+		m_Cells[m_Cell[sprite]] = next;
+	}
+	else {
+		m_Cells.erase(m_Cell[sprite]);
+	}
+}
+
+unsigned int SpriteGrid::Query(const glm::vec2& min, const glm::vec2& max, std::vector<unsigned int>& visible) const {
+	const size_t start = visible.size();
+	auto gather = [&](unsigned int sprite) {
+		for (; sprite != NONE; sprite = m_Next[sprite]) {
+			const glm::vec2& center = m_Center[sprite];
+			const glm::vec2& halfSize = m_HalfSize[sprite];
+			if (center.x + halfSize.x >= min.x && center.x - halfSize.x <= max.x &&
+				center.y + halfSize.y >= min.y && center.y - halfSize.y <= max.y) {
+				visible.push_back(sprite);
+			}
+		}
+	};
+
+	// A sprite overlapping the rectangle has its center at most its half size outside it
+	const int firstX = (int)std::floor((min.x - m_MaxHalfSize.x) / m_CellSize);
+	const int firstY = (int)std::floor((min.y - m_MaxHalfSize.y) / m_CellSize);
+	const int lastX = (int)std::floor((max.x + m_MaxHalfSize.x) / m_CellSize);
+	const int lastY = (int)std::floor((max.y + m_MaxHalfSize.y) / m_CellSize);
+	const double cellCount = ((double)lastX - firstX + 1) * ((double)lastY - firstY + 1);
+
+	if (cellCount > (double)m_Cells.size()) {
+		// Zoomed out past the occupied part of the world, walking what exists is cheaper
+		for (const auto& cell : m_Cells) {
+			const int x = (int)(uint32_t)(cell.first >> 32);
+			const int y = (int)(uint32_t)cell.first;
+			if (x >= firstX && x <= lastX && y >= firstY && y <= lastY) {
+				gather(cell.second);
+			}
+		}
+	}
+	else {
+		for (int y = firstY; y <= lastY; y++) {
+			for (int x = firstX; x <= lastX; x++) {
+				auto cell = m_Cells.find(PackCell(x, y));
+				if (cell != m_Cells.end()) {
+					gather(cell->second);
+				}
+			}
+		}
+	}
+	return (unsigned int)(visible.size() - start);
+}
+
+void SpriteGrid::GetViewRect(const glm::mat4& viewProjection, glm::vec2& min, glm::vec2& max) {
+	const glm::mat4 inverse = glm::inverse(viewProjection);
+	min = glm::vec2(FLT_MAX);
+	max = glm::vec2(-FLT_MAX);
+	for (int corner = 0; corner < 4; corner++) {
+		const glm::vec4 world = inverse * glm::vec4(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, 0.0f, 1.0f);
+		const glm::vec2 point = glm::vec2(world) / world.w;
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+}
\ No newline at end of file
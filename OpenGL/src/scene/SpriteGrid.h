@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// Uniform grid over an unbounded 2D world, hashed so only occupied cells take memory. Each
+// sprite sits in the cell of its center, linked into that cell's list, so insert, remove and
+// move are O(1). Queries widen the rectangle by the largest sprite half size and visit only
+// the cells it covers, so a frame costs what is on screen, not what is in the world:
+//
+//     glm::vec2 viewMin, viewMax;
+//     SpriteGrid::GetViewRect(proj * view, viewMin, viewMax);
+//     visible.clear();
+//     grid.Query(viewMin, viewMax, visible); // Sprite ids to draw this frame
+class SpriteGrid {
+private:
+	static constexpr unsigned int NONE = 0xFFFFFFFF;
+
+	float m_CellSize;
+	glm::vec2 m_MaxHalfSize = glm::vec2(0.0f); // Of any sprite inserted so far, never shrinks
+
+	// Per sprite id
+	std::vector<glm::vec2> m_Center;
+	std::vector<glm::vec2> m_HalfSize;
+	std::vector<unsigned int> m_Next, m_Previous; // Within the cell, NONE at the ends
+	std::vector<uint64_t> m_Cell;
+	std::vector<unsigned char> m_Alive;
+	std::vector<unsigned int> m_FreeIds;
+	unsigned int m_Count = 0;
+
+	std::unordered_map<uint64_t, unsigned int> m_Cells; // Occupied cell to its first sprite
+public:
+	explicit SpriteGrid(float cellSize = 128.0f); // A few sprites across works well
+
+	unsigned int Insert(const glm::vec2& center, const glm::vec2& halfSize); // Returns the sprite's id
+	void Remove(unsigned int sprite);
+	void Move(unsigned int sprite, const glm::vec2& center); // Relinks only when the cell changes
+
+	// Appends the id of every sprite overlapping [min, max], returns how many were appended
+	unsigned int Query(const glm::vec2& min, const glm::vec2& max, std::vector<unsigned int>& visible) const;
+
+	inline const glm::vec2& GetCenter(unsigned int sprite) const { return m_Center[sprite]; }
+	inline const glm::vec2& GetHalfSize(unsigned int sprite) const { return m_HalfSize[sprite]; }
+	inline bool IsValid(unsigned int sprite) const { return sprite < m_Alive.size() && m_Alive[sprite]; }
+	inline unsigned int GetCount() const { return m_Count; }
+	inline unsigned int GetOccupiedCellCount() const { return (unsigned int)m_Cells.size(); }
+
+	// World rectangle an orthographic view-projection shows, e.g. (0, 0) to (960, 540) for main's proj
+	static void GetViewRect(const glm::mat4& viewProjection, glm::vec2& min, glm::vec2& max);
+private:
+	uint64_t GetCellKey(const glm::vec2& position) const;
+	void Link(unsigned int sprite);
+	void Unlink(unsigned int sprite);
+};
\ No newline at end of file
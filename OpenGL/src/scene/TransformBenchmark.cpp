@@ -0,0 +1,58 @@
+#include "TransformBenchmark.h"
+#include "TransformSystem.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include "glm/gtc/matrix_transform.hpp"
+
+// Average milliseconds of one call of frame, after a warm-up call
+template<typename Frame>
+static double TimeFrames(unsigned int frames, const Frame& frame) {
+	frame();
+	auto start = std::chrono::steady_clock::now();
+	for (unsigned int i = 0; i < frames; i++) {
+		frame();
+	}
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+void RunTransformBenchmark() {
+	const unsigned int counts[] = { 10000, 100000, 1000000 };
+	const glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f)
+		* glm::lookAt(glm::vec3(0.0f, 50.0f, 200.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	printf("Transform benchmark, SIMD kernel: %s\n", TransformSystem::GetKernelName());
+	printf("%10s %14s %14s %9s %12s\n", "objects", "scalar ms", "simd ms", "speedup", "max error");
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	for (unsigned int count : counts) {
+		TransformSystem transforms;
+		transforms.Reserve(count);
+		for (unsigned int i = 0; i < count; i++) {
+			glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)) + glm::vec3(0.0f, 0.0f, 1e-3f));
+			transforms.Add(glm::vec3(unit(random), unit(random), unit(random)) * 100.0f,
+				glm::angleAxis(unit(random) * 3.14159f, axis),
+				glm::vec3(1.0f + unit(random) * 0.5f));
+		}
+
+		// Writes go to a plain array here, in a frame they go to a mapped instance buffer
+		std::vector<glm::mat4> scalar(count), simd(count);
+		const unsigned int frames = count >= 1000000 ? 10 : 100;
+		double scalarMs = TimeFrames(frames, [&]() { transforms.ComputeScalar(viewProjection, nullptr, scalar.data(), 0, count); });
+		double simdMs = TimeFrames(frames, [&]() { transforms.Compute(viewProjection, nullptr, simd.data()); });
+
+		float maxError = 0.0f;
+		for (unsigned int i = 0; i < count; i++) {
+			for (int c = 0; c < 4; c++) {
+				glm::vec4 difference = glm::abs(scalar[i][c] - simd[i][c]);
+				maxError = glm::max(maxError, glm::max(glm::max(difference.x, difference.y), glm::max(difference.z, difference.w)));
+			}
+		}
+		printf("%10u %14.3f %14.3f %8.2fx %12g\n", count, scalarMs, simdMs, scalarMs / simdMs, maxError);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+#pragma once
+
+// Times TransformSystem for 10k, 100k and 1M objects per frame, the glm scalar path against the
+// SIMD kernel, and checks both agree. Prints a table to stdout, needs no GL context.
+void RunTransformBenchmark();
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "TransformSystem.h"
+#include "../buffers/VertexBuffer.h"
+#include "../buffers/RingBuffer.h"
+#include "../Renderer.h"
+
+// SSE2 is always there on x64 and with /arch:SSE2 on x86, AVX needs /arch:AVX or newer
+#if defined(__AVX__)
+#define TRANSFORM_SIMD_AVX
+#include <immintrin.h>
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+unsigned int TransformSystem::Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+	m_PositionX.push_back(position.x);
+	m_PositionY.push_back(position.y);
+	m_PositionZ.push_back(position.z);
+	m_RotationX.push_back(rotation.x);
+	m_RotationY.push_back(rotation.y);
+	m_RotationZ.push_back(rotation.z);
+	m_RotationW.push_back(rotation.w);
+	m_ScaleX.push_back(scale.x);
+	m_ScaleY.push_back(scale.y);
+	m_ScaleZ.push_back(scale.z);
+	return GetCount() - 1;
+}
+
+void TransformSystem::RemoveSwap(unsigned int index) {
+	ASSERT(index < GetCount());
+	for (std::vector<float>* array : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_RotationX, &m_RotationY,
+		&m_RotationZ, &m_RotationW, &m_ScaleX, &m_ScaleY, &m_ScaleZ })
+	{
+		(*array)[index] = array->back();
+		array->pop_back();
+	}
+}
+
+void TransformSystem::Reserve(unsigned int count) {
+	for (std::vector<float>* array : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_RotationX, &m_RotationY,
+		&m_RotationZ, &m_RotationW, &m_ScaleX, &m_ScaleY, &m_ScaleZ })
+	{
+		array->reserve(count);
+	}
+}
+
+void TransformSystem::Clear() {
+	for (std::vector<float>* array : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_RotationX, &m_RotationY,
+		&m_RotationZ, &m_RotationW, &m_ScaleX, &m_ScaleY, &m_ScaleZ })
+	{
+		array->clear();
+	}
+}
+
+void TransformSystem::SetPosition(unsigned int index, const glm::vec3& position) {
+	m_PositionX[index] = position.x;
+	m_PositionY[index] = position.y;
+	m_PositionZ[index] = position.z;
+}
+
+void TransformSystem::SetRotation(unsigned int index, const glm::quat& rotation) {
+	m_RotationX[index] = rotation.x;
+	m_RotationY[index] = rotation.y;
+	m_RotationZ[index] = rotation.z;
+	m_RotationW[index] = rotation.w;
+}
+
+void TransformSystem::SetScale(unsigned int index, const glm::vec3& scale) {
+	m_ScaleX[index] = scale.x;
+	m_ScaleY[index] = scale.y;
+	m_ScaleZ[index] = scale.z;
+}
+
+glm::vec3 TransformSystem::GetPosition(unsigned int index) const {
+	return glm::vec3(m_PositionX[index], m_PositionY[index], m_PositionZ[index]);
+}
+
+glm::quat TransformSystem::GetRotation(unsigned int index) const {
+	return glm::quat(m_RotationW[index], m_RotationX[index], m_RotationY[index], m_RotationZ[index]);
+}
+
+glm::vec3 TransformSystem::GetScale(unsigned int index) const {
+	return glm::vec3(m_ScaleX[index], m_ScaleY[index], m_ScaleZ[index]);
+}
+
+void TransformSystem::ComputeScalar(const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* mvp, unsigned int first, unsigned int count) const {
+	for (unsigned int i = 0; i < count; i++) {
+		const unsigned int o = first + i;
+		glm::mat4 matrix = glm::mat4_cast(glm::quat(m_RotationW[o], m_RotationX[o], m_RotationY[o], m_RotationZ[o]));
+		matrix[0] *= m_ScaleX[o];
+		matrix[1] *= m_ScaleY[o];
+		matrix[2] *= m_ScaleZ[o];
+		matrix[3] = glm::vec4(m_PositionX[o], m_PositionY[o], m_PositionZ[o], 1.0f);
+		if (world) {
+			world[i] = matrix;
+		}
+		if (mvp) {
+			mvp[i] = viewProjection * matrix;
+		}
+	}
+}
+
+#if defined(TRANSFORM_SIMD_AVX) || defined(TRANSFORM_SIMD_SSE)
+
+// Thin wrappers so one kernel serves both register widths
+#if defined(TRANSFORM_SIMD_AVX)
+struct SimdLanes {
+	typedef __m256 Vector;
+	static const unsigned int WIDTH = 8;
+	static inline Vector Load(const float* p) { return _mm256_loadu_ps(p); }
+	static inline Vector Set1(float value) { return _mm256_set1_ps(value); }
+	static inline Vector Zero() { return _mm256_setzero_ps(); }
+	static inline Vector Add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+	static inline Vector Sub(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+	static inline Vector Mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+
+	// matrix[c * 4 + r] holds element (column c, row r) of 8 objects, write them out as 8 glm::mat4
+	static inline void StoreMatrices(const Vector* matrix, glm::mat4* output) {
+		float* out = &output[0][0][0];
+		for (int c = 0; c < 4; c++) {
+			for (int half = 0; half < 2; half++) {
+				__m128 r0 = half ? _mm256_extractf128_ps(matrix[c * 4 + 0], 1) : _mm256_castps256_ps128(matrix[c * 4 + 0]);
+				__m128 r1 = half ? _mm256_extractf128_ps(matrix[c * 4 + 1], 1) : _mm256_castps256_ps128(matrix[c * 4 + 1]);
+				__m128 r2 = half ? _mm256_extractf128_ps(matrix[c * 4 + 2], 1) : _mm256_castps256_ps128(matrix[c * 4 + 2]);
+				__m128 r3 = half ? _mm256_extractf128_ps(matrix[c * 4 + 3], 1) : _mm256_castps256_ps128(matrix[c * 4 + 3]);
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3); // Now one register per object, holding its column c
+				float* base = out + half * 4 * 16 + c * 4;
+				_mm_storeu_ps(base + 0 * 16, r0);
+				_mm_storeu_ps(base + 1 * 16, r1);
+				_mm_storeu_ps(base + 2 * 16, r2);
+				_mm_storeu_ps(base + 3 * 16, r3);
+			}
+		}
+	}
+};
+#else
+struct SimdLanes {
+	typedef __m128 Vector;
+	static const unsigned int WIDTH = 4;
+	static inline Vector Load(const float* p) { return _mm_loadu_ps(p); }
+	static inline Vector Set1(float value) { return _mm_set1_ps(value); }
+	static inline Vector Zero() { return _mm_setzero_ps(); }
+	static inline Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+	static inline Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+	static inline Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+
+	// matrix[c * 4 + r] holds element (column c, row r) of 4 objects, write them out as 4 glm::mat4
+	static inline void StoreMatrices(const Vector* matrix, glm::mat4* output) {
+		float* out = &output[0][0][0];
+		for (int c = 0; c < 4; c++) {
+			__m128 r0 = matrix[c * 4 + 0], r1 = matrix[c * 4 + 1], r2 = matrix[c * 4 + 2], r3 = matrix[c * 4 + 3];
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3); // Now one register per object, holding its column c
+			_mm_storeu_ps(out + 0 * 16 + c * 4, r0);
+			_mm_storeu_ps(out + 1 * 16 + c * 4, r1);
+			_mm_storeu_ps(out + 2 * 16 + c * 4, r2);
+			_mm_storeu_ps(out + 3 * 16 + c * 4, r3);
+		}
+	}
+};
+#endif
+
+void TransformSystem::Compute(const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* mvp, unsigned int first, unsigned int count) const {
+	typedef SimdLanes S;
+	typedef S::Vector V;
+	ASSERT(first + count <= GetCount());
+
+	const V zero = S::Zero();
+	const V one = S::Set1(1.0f);
+	const V two = S::Set1(2.0f);
+	V vp[16]; // Every object shares the view-projection, broadcast each element once
+	for (int c = 0; c < 4; c++) {
+		for (int r = 0; r < 4; r++) {
+			vp[c * 4 + r] = S::Set1(viewProjection[c][r]);
+		}
+	}
+
+	unsigned int i = 0;
+	for (; i + S::WIDTH <= count; i += S::WIDTH) {
+		const unsigned int o = first + i;
+		const V qx = S::Load(&m_RotationX[o]), qy = S::Load(&m_RotationY[o]), qz = S::Load(&m_RotationZ[o]), qw = S::Load(&m_RotationW[o]);
+		const V sx = S::Load(&m_ScaleX[o]), sy = S::Load(&m_ScaleY[o]), sz = S::Load(&m_ScaleZ[o]);
+
+		const V xx = S::Mul(qx, qx), yy = S::Mul(qy, qy), zz = S::Mul(qz, qz);
+		const V xy = S::Mul(qx, qy), xz = S::Mul(qx, qz), yz = S::Mul(qy, qz);
+		const V wx = S::Mul(qw, qx), wy = S::Mul(qw, qy), wz = S::Mul(qw, qz);
+
+		// T * R * S in structure-of-arrays form, same layout as glm::mat4_cast
+		V w[16];
+		w[0] = S::Mul(S::Sub(one, S::Mul(two, S::Add(yy, zz))), sx);
+		w[1] = S::Mul(S::Mul(two, S::Add(xy, wz)), sx);
+		w[2] = S::Mul(S::Mul(two, S::Sub(xz, wy)), sx);
+		w[3] = zero;
+		w[4] = S::Mul(S::Mul(two, S::Sub(xy, wz)), sy);
+		w[5] = S::Mul(S::Sub(one, S::Mul(two, S::Add(xx, zz))), sy);
+		w[6] = S::Mul(S::Mul(two, S::Add(yz, wx)), sy);
+		w[7] = zero;
+		w[8] = S::Mul(S::Mul(two, S::Add(xz, wy)), sz);
+		w[9] = S::Mul(S::Mul(two, S::Sub(yz, wx)), sz);
+		w[10] = S::Mul(S::Sub(one, S::Mul(two, S::Add(xx, yy))), sz);
+		w[11] = zero;
+		w[12] = S::Load(&m_PositionX[o]);
+		w[13] = S::Load(&m_PositionY[o]);
+		w[14] = S::Load(&m_PositionZ[o]);
+		w[15] = one;
+
+		if (world) {
+			S::StoreMatrices(w, world + i);
+		}
+		if (mvp) {
+			// Column c of the product is viewProjection * world[c], the world's bottom row is (0, 0, 0, 1)
+			V m[16];
+			for (int c = 0; c < 4; c++) {
+				for (int r = 0; r < 4; r++) {
+					V sum = S::Add(S::Add(S::Mul(vp[0 + r], w[c * 4 + 0]), S::Mul(vp[4 + r], w[c * 4 + 1])), S::Mul(vp[8 + r], w[c * 4 + 2]));
+					m[c * 4 + r] = c == 3 ? S::Add(sum, vp[12 + r]) : sum;
+				}
+			}
+			S::StoreMatrices(m, mvp + i);
+		}
+	}
+
+	// Fewer objects than a register holds are left, finish them one by one
+	ComputeScalar(viewProjection, world ? world + i : nullptr, mvp ? mvp + i : nullptr, first + i, count - i);
+}
+
+#else
+
+void TransformSystem::Compute(const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* mvp, unsigned int first, unsigned int count) const {
+	ComputeScalar(viewProjection, world, mvp, first, count); // No SIMD on this target
+}
+
+#endif
+
+void TransformSystem::WriteInstances(VertexBuffer& instances, const glm::mat4& viewProjection) const {
+	const unsigned int size = GetCount() * (unsigned int)sizeof(glm::mat4);
+	ASSERT(size <= instances.GetSize());
+	if (size == 0) {
+		return;
+	}
+
+	instances.Orphan(); // Last frame's instances may still be read by the GPU, write into fresh storage
+	glm::mat4* mapped = static_cast<glm::mat4*>(instances.Map(0, size));
+	if (!mapped) {
+		return;
+	}
+	Compute(viewProjection, nullptr, mapped);
+	instances.Unmap();
+}
+
+RingAllocation TransformSystem::WriteInstances(RingBuffer& instances, const glm::mat4& viewProjection) const {
+	// Aligned to a whole matrix so the offset converts to a base instance
+	RingAllocation allocation = instances.Allocate(GetCount() * (unsigned int)sizeof(glm::mat4), (unsigned int)sizeof(glm::mat4));
+	if (allocation.IsValid()) {
+		Compute(viewProjection, nullptr, static_cast<glm::mat4*>(allocation.data)); // Coherent mapping, visible without a flush
+	}
+	return allocation;
+}
+
+const char* TransformSystem::GetKernelName() {
+#if defined(TRANSFORM_SIMD_AVX)
+	return "AVX";
+#elif defined(TRANSFORM_SIMD_SSE)
+	return "SSE";
+#else
+	return "Scalar";
+#endif
+}
\ No newline at end of file
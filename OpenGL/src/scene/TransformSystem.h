@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+class VertexBuffer;
+class RingBuffer;
+struct RingAllocation;
+
+// Translation, rotation and scale of many objects in structure-of-arrays form, so the SIMD
+// kernels load the same component of 4 (SSE) or 8 (AVX) objects with one instruction.
+// Matrices come out column-major, one glm::mat4 per object, ready for an instance buffer.
+class TransformSystem {
+private:
+	std::vector<float> m_PositionX, m_PositionY, m_PositionZ;
+	std::vector<float> m_RotationX, m_RotationY, m_RotationZ, m_RotationW; // Unit quaternions
+	std::vector<float> m_ScaleX, m_ScaleY, m_ScaleZ;
+public:
+	TransformSystem() = default;
+
+	unsigned int Add(const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), const glm::vec3& scale = glm::vec3(1.0f)); // Returns the object's index
+	void RemoveSwap(unsigned int index); // Moves the last object into index
+	void Reserve(unsigned int count);
+	void Clear();
+
+	void SetPosition(unsigned int index, const glm::vec3& position);
+	void SetRotation(unsigned int index, const glm::quat& rotation); // Must be normalized
+	void SetScale(unsigned int index, const glm::vec3& scale);
+	glm::vec3 GetPosition(unsigned int index) const;
+	glm::quat GetRotation(unsigned int index) const;
+	glm::vec3 GetScale(unsigned int index) const;
+
+	// Writes world = T * R * S and/or mvp = viewProjection * world for objects [first, first + count),
+	// either output may be nullptr. Outputs are indexed from 0, so mvp can be a mapped buffer range.
+	void Compute(const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* mvp, unsigned int first, unsigned int count) const;
+	inline void Compute(const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* mvp) const { Compute(viewProjection, world, mvp, 0, GetCount()); }
+
+	// Same results with plain glm math, the reference for the SIMD kernels and their tail
+	void ComputeScalar(const glm::mat4& viewProjection, glm::mat4* world, glm::mat4* mvp, unsigned int first, unsigned int count) const;
+
+	// Maps the instance buffer and writes every MVP straight into it, no staging copy.
+	// The buffer needs GetCount() * sizeof(glm::mat4) bytes, see VertexArray::AddInstanceBuffer.
+	void WriteInstances(VertexBuffer& instances, const glm::mat4& viewProjection) const;
+
+	// Same, into this frame's region of a persistently mapped ring, so there is no map or orphan at all.
+	// Draw with allocation.offset / sizeof(glm::mat4) as the base instance, the allocation is invalid if the region is full.
+	RingAllocation WriteInstances(RingBuffer& instances, const glm::mat4& viewProjection) const;
+
+	inline unsigned int GetCount() const { return (unsigned int)m_PositionX.size(); }
+
+	static const char* GetKernelName(); // "AVX", "SSE" or "Scalar", fixed at compile time
+};
\ No newline at end of file